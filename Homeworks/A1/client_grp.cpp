@@ -12,10 +12,11 @@
 #include <cstdlib>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include "profiled_mutex.h"
 
 #define BUFFER_SIZE 1024
 
-std::mutex cout_mutex;
+ProfiledMutex cout_mutex("cout_mutex");
 
 void handle_server_messages(int server_socket) {
     char buffer[BUFFER_SIZE];
@@ -23,12 +24,12 @@ void handle_server_messages(int server_socket) {
         memset(buffer, 0, BUFFER_SIZE);
         int bytes_received = recv(server_socket, buffer, BUFFER_SIZE, 0);
         if (bytes_received <= 0) {
-            std::lock_guard<std::mutex> lock(cout_mutex);
+            ProfiledLock<ProfiledMutex> lock(cout_mutex);
             std::cout << "Disconnected from server." << std::endl;
             close(server_socket);
             exit(0);
         }
-        std::lock_guard<std::mutex> lock(cout_mutex);
+        ProfiledLock<ProfiledMutex> lock(cout_mutex);
         std::cout << buffer << std::endl;
     }
 }
@@ -6,6 +6,8 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include "packet_templates.h"
+#include "packet_trace.h"
 
 #define SERVER_PORT 12345  // Server's listening port
 #define CLIENT_PORT 54321  // Client's port
@@ -21,105 +23,66 @@ void print_tcp_flags(struct tcphdr *tcp) {
               << " SEQ: " << ntohl(tcp->seq) << std::endl;
 }
 
+// Preallocated packet buffers; only the variable fields are patched on each send
+static pkt::PacketBuilder syn_builder(pkt::SYN_TEMPLATE);
+static pkt::PacketBuilder ack_builder(pkt::ACK_TEMPLATE);
+
 // Function to send SYN packet to initiate handshake
 void send_syn(int sock, struct sockaddr_in *server_addr) {
 
-    // Allocate memory for packet
-    char packet[sizeof(struct iphdr) + sizeof(struct tcphdr)];
-    memset(packet, 0, sizeof(packet));
-
-    // Set up IP and TCP header pointers
-    struct iphdr *ip = (struct iphdr *)packet;
-    struct tcphdr *tcp = (struct tcphdr *)(packet + sizeof(struct iphdr));
-
-    // Fill IP header
-    ip->ihl = 5;                                    // Header length (5 words * 4 bytes/word = 20 bytes)
-    ip->version = 4;                                // IPv4 
-    ip->tos = 0;                                    // Type of service
-    ip->tot_len = htons(sizeof(packet));            //Length of the packet
-    ip->id = htons(12345);                          // Unique ID for the packet
-    ip->frag_off = 0;                               // Fragment offset
-    ip->ttl = 64;                                   // Time to live
-    ip->protocol = IPPROTO_TCP;
-    // Send ACK from client (source) to server (destination)
-    ip->saddr = inet_addr("127.0.0.1");             // Client address
-    ip->daddr = server_addr->sin_addr.s_addr;       // Server address
-
-    // Fill TCP header
-    tcp->source = htons(CLIENT_PORT);               // Source is Client port
-    tcp->dest = htons(SERVER_PORT);                 // Destination is Server port    
-    tcp->seq = htonl(200);                          // Set sequence number to 200 for SYN packet
-    tcp->ack_seq = 0;                               // Not an ACK
-    tcp->doff = 5;                                  // Data offset (5 words * 4 bytes/word = 20 bytes)
-    //Set Appropriate Flags
-    tcp->syn = 1;                                   // SYN flag true
-    tcp->ack = 0;                                   // Not an ACK
-    tcp->window = htons(8192);                      // Window size
-    tcp->check = 0;                                 // Kernel will compute checksum if needed
-    // tcp->urg_ptr = 0;
+    // Patch addresses, ports and numbers into the prebuilt SYN packet
+    // (version, lengths, ID, TTL, SYN flag and window come from SYN_TEMPLATE)
+    const char *packet = syn_builder.build(htonl(INADDR_LOOPBACK),          // Client address
+                                           server_addr->sin_addr.s_addr,    // Server address
+                                           CLIENT_PORT,                     // Source is Client port
+                                           SERVER_PORT,                     // Destination is Server port
+                                           200,                             // Sequence number 200 for SYN packet
+                                           0);                              // Not an ACK
 
     // Send packet
-    if (sendto(sock, packet, sizeof(packet), 0, (struct sockaddr *)server_addr, sizeof(*server_addr)) < 0) {
+    if (sendto(sock, packet, syn_builder.size(), 0, (struct sockaddr *)server_addr, sizeof(*server_addr)) < 0) {
         // If sendto fails, print error message and exit
         perror("sendto() failed");
         exit(EXIT_FAILURE);
     } else {
-        // If sendto succeeds, print the sent packet information
-        std::cout << "[+] Sent SYN packet with SEQ=" << ntohl(tcp->seq) << std::endl;
+        // If sendto succeeds, record and print the sent packet information
+        trace::record(syn_builder.ip(), syn_builder.tcp());
+        std::cout << "[+] Sent SYN packet with SEQ=" << ntohl(syn_builder.tcp()->seq) << std::endl;
     }
 }
 
 // Function to send ACK packet to complete handshake
 void send_ack(int sock, struct sockaddr_in *server_addr, struct tcphdr *received_tcp) {
-    // Allocate memory for the packet
-    char packet[sizeof(struct iphdr) + sizeof(struct tcphdr)];
-    memset(packet, 0, sizeof(packet));
-
-    // Set up IP and TCP header pointers
-    struct iphdr *ip = (struct iphdr *)packet;
-    struct tcphdr *tcp = (struct tcphdr *)(packet + sizeof(struct iphdr));
-
-    // Fill IP header
-    ip->ihl = 5;                                    // Header length (5 words * 4 bytes/word = 20 bytes)
-    ip->version = 4;                                // IPv4
-    ip->tos = 0;                                    // Type of service
-    ip->tot_len = htons(sizeof(packet));            // Length of the packet
-    ip->id = htons(12346);                          // Unique ID for the packet
-    ip->frag_off = 0;                               // Fragment offset
-    ip->ttl = 64;                                   // Time to live
-    ip->protocol = IPPROTO_TCP;                     // TCP protocol
-    // Send ACK from client (source) to server (destination)
-    ip->saddr = inet_addr("127.0.0.1");             // Client address
-    ip->daddr = server_addr->sin_addr.s_addr;       // Server address
-
-    // Fill TCP header
-
-    //Set source and destination ports by switching received TCP ports
-    tcp->source = received_tcp->dest;               // Source port
-    tcp->dest = received_tcp->source;               // Destination port
-    tcp->seq = htonl(600);                          // Set sequence number to 600
-    tcp->ack_seq = htonl(ntohl(received_tcp->seq) + 1);  // Set ACK seq number to server's sequence number + 1
-    //Set Appropriate Flags
-    tcp->doff = 5;                                  // Data offset (5 words * 4 bytes/word = 20 bytes)
-    tcp->syn = 0;                                   // Not SYN
-    tcp->ack = 1;                                   // ACK flag
-    tcp->window = htons(8192);                      // Window size
-    tcp->check = 0;                                 // Kernel will compute the checksum
-    // tcp->urg_ptr = 0;
+
+    // Patch addresses, ports and numbers into the prebuilt ACK packet
+    // Source and destination ports are switched from the received TCP header
+    const char *packet = ack_builder.build(htonl(INADDR_LOOPBACK),          // Client address
+                                           server_addr->sin_addr.s_addr,    // Server address
+                                           ntohs(received_tcp->dest),       // Source port
+                                           ntohs(received_tcp->source),     // Destination port
+                                           600,                             // Sequence number 600
+                                           ntohl(received_tcp->seq) + 1);   // Server's sequence number + 1
 
     // Send packet
-    if (sendto(sock, packet, sizeof(packet), 0, (struct sockaddr *)server_addr, sizeof(*server_addr)) < 0) {
+    if (sendto(sock, packet, ack_builder.size(), 0, (struct sockaddr *)server_addr, sizeof(*server_addr)) < 0) {
         // If sendto fails, print error message and exit
         perror("sendto() failed");
         exit(EXIT_FAILURE);
     } else {
-        // If sendto succeeds, print the sent packet information
+        // If sendto succeeds, record and print the sent packet information
+        struct tcphdr *tcp = ack_builder.tcp();
+        trace::record(ack_builder.ip(), tcp);
         std::cout << "[+] Sent ACK packet with SEQ=" << ntohl(tcp->seq) 
                   << " and ACK=" << ntohl(tcp->ack_seq) << std::endl;
     }
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    // Select trace verbosity and optional pcap output (-v, -w)
+    if (!trace::configure(argc, argv)) {
+        exit(EXIT_FAILURE);
+    }
+
     // Create raw socket
     int sock = socket(AF_INET, SOCK_RAW, IPPROTO_TCP);
     if (sock < 0) {
@@ -171,8 +134,10 @@ int main() {
             continue;
         }
 
-        // Print received packet information
-        print_tcp_flags(tcp);
+        // Record and print received packet information
+        trace::record(ip, tcp);
+        if (trace::verbosity() >= trace::PRINT)
+            print_tcp_flags(tcp);
 
         // If it's a SYN-ACK packet with expected sequence number (400)
         // then print and send final ACK to complete the handshake
@@ -0,0 +1,140 @@
+#ifndef PACKET_TEMPLATES_H
+#define PACKET_TEMPLATES_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// Compile-time packet templates for the handshake packets (SYN, SYN-ACK, ACK).
+//
+// Every field of the IP and TCP headers that is the same for all packets of a kind
+// (version, lengths, IP id, TTL, protocol, data offset, flags, window) is laid out at
+// compile time, together with the one's complement sums of those constant words.
+// At send time a PacketBuilder only writes the addresses, ports, SEQ and ACK into its
+// preallocated buffer and finishes both checksums from the precomputed partial sums.
+
+namespace pkt {
+
+constexpr std::size_t IP_HDR_LEN = 20;                      // 5 words, no options
+constexpr std::size_t TCP_HDR_LEN = 20;                     // 5 words, no options
+constexpr std::size_t PACKET_LEN = IP_HDR_LEN + TCP_HDR_LEN;
+
+static_assert(sizeof(struct iphdr) == IP_HDR_LEN, "unexpected iphdr layout");
+static_assert(sizeof(struct tcphdr) == TCP_HDR_LEN, "unexpected tcphdr layout");
+
+using Bytes = std::array<std::uint8_t, PACKET_LEN>;
+
+struct HeaderTemplate {
+    Bytes bytes{};                  // Packet with all variable fields left as zero
+    std::uint32_t ip_partial = 0;   // Unfolded sum of the constant IP header words
+    std::uint32_t tcp_partial = 0;  // Unfolded sum of the constant TCP and pseudo-header words
+};
+
+// Store a 16-bit value in network byte order
+constexpr void put16(Bytes &b, std::size_t off, std::uint16_t v) {
+    b[off] = static_cast<std::uint8_t>(v >> 8);
+    b[off + 1] = static_cast<std::uint8_t>(v);
+}
+
+// One's complement sum of the 16-bit words in [begin, end), without folding
+constexpr std::uint32_t sum_words(const Bytes &b, std::size_t begin, std::size_t end) {
+    std::uint32_t sum = 0;
+    for (std::size_t i = begin; i < end; i += 2)
+        sum += (static_cast<std::uint32_t>(b[i]) << 8) | b[i + 1];
+    return sum;
+}
+
+// Fold the carries of a 32-bit sum back into 16 bits
+constexpr std::uint16_t fold(std::uint32_t sum) {
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<std::uint16_t>(sum);
+}
+
+constexpr HeaderTemplate make_template(std::uint16_t ip_id, std::uint8_t tcp_flags,
+                                       std::uint16_t window, std::uint8_t ttl = 64) {
+    HeaderTemplate t{};
+
+    // IP header: saddr, daddr and checksum are patched per packet
+    t.bytes[0] = 0x45;                                  // Version 4, header length 5 words
+    t.bytes[1] = 0;                                     // Type of service
+    put16(t.bytes, 2, PACKET_LEN);                      // Total length
+    put16(t.bytes, 4, ip_id);                           // Identification
+    put16(t.bytes, 6, 0);                               // Fragment offset
+    t.bytes[8] = ttl;                                   // Time to live
+    t.bytes[9] = IPPROTO_TCP;                           // Protocol
+
+    // TCP header: ports, seq, ack_seq and checksum are patched per packet
+    t.bytes[IP_HDR_LEN + 12] = (TCP_HDR_LEN / 4) << 4;  // Data offset
+    t.bytes[IP_HDR_LEN + 13] = tcp_flags;               // Control flags
+    put16(t.bytes, IP_HDR_LEN + 14, window);            // Window size
+
+    // Variable fields are still zero here, so the sums only cover constant words.
+    // The TCP sum also carries the constant half of the pseudo-header (protocol, length).
+    t.ip_partial = sum_words(t.bytes, 0, IP_HDR_LEN);
+    t.tcp_partial = sum_words(t.bytes, IP_HDR_LEN, PACKET_LEN) + IPPROTO_TCP + TCP_HDR_LEN;
+    return t;
+}
+
+// Packet kinds used by the handshake
+constexpr HeaderTemplate SYN_TEMPLATE = make_template(12345, TH_SYN, 8192);
+constexpr HeaderTemplate SYN_ACK_TEMPLATE = make_template(54321, TH_SYN | TH_ACK, 8192);
+constexpr HeaderTemplate ACK_TEMPLATE = make_template(12346, TH_ACK, 8192);
+
+static_assert(SYN_TEMPLATE.bytes[0] == 0x45 && SYN_TEMPLATE.bytes[IP_HDR_LEN + 13] == TH_SYN,
+              "SYN template laid out incorrectly");
+
+// Sum of the two 16-bit halves of a host order 32-bit value
+inline std::uint32_t sum32(std::uint32_t v) {
+    return (v >> 16) + (v & 0xffff);
+}
+
+// Owns a preallocated packet buffer initialised from a template
+class PacketBuilder {
+public:
+    explicit PacketBuilder(const HeaderTemplate &tmpl)
+        : ip_partial_(tmpl.ip_partial), tcp_partial_(tmpl.tcp_partial) {
+        memcpy(buf_, tmpl.bytes.data(), PACKET_LEN);
+    }
+
+    // Patch the per-packet fields and return the finished packet.
+    // Addresses are in network byte order (as in sockaddr_in), ports and numbers in host order.
+    const char *build(in_addr_t saddr, in_addr_t daddr, std::uint16_t sport, std::uint16_t dport,
+                      std::uint32_t seq, std::uint32_t ack_seq) {
+        std::uint32_t addr_sum = sum32(ntohl(saddr)) + sum32(ntohl(daddr));
+
+        struct iphdr *ip = this->ip();
+        ip->saddr = saddr;
+        ip->daddr = daddr;
+        ip->check = htons(static_cast<std::uint16_t>(~fold(ip_partial_ + addr_sum)));
+
+        struct tcphdr *tcp = this->tcp();
+        tcp->source = htons(sport);
+        tcp->dest = htons(dport);
+        tcp->seq = htonl(seq);
+        tcp->ack_seq = htonl(ack_seq);
+        std::uint32_t tcp_sum = tcp_partial_ + addr_sum + sport + dport + sum32(seq) + sum32(ack_seq);
+        tcp->check = htons(static_cast<std::uint16_t>(~fold(tcp_sum)));
+
+        return buf_;
+    }
+
+    struct iphdr *ip() { return reinterpret_cast<struct iphdr *>(buf_); }
+    struct tcphdr *tcp() { return reinterpret_cast<struct tcphdr *>(buf_ + IP_HDR_LEN); }
+    const char *data() const { return buf_; }
+    std::size_t size() const { return PACKET_LEN; }
+
+private:
+    std::uint32_t ip_partial_;
+    std::uint32_t tcp_partial_;
+    alignas(4) char buf_[PACKET_LEN];
+};
+
+} // namespace pkt
+
+#endif // PACKET_TEMPLATES_H
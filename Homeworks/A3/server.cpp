@@ -6,6 +6,8 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include "packet_templates.h"
+#include "packet_trace.h"
 
 #define SERVER_PORT 12345  // Listening port
 
@@ -19,40 +21,23 @@ void print_tcp_flags(struct tcphdr *tcp) {
               << " SEQ: " << ntohl(tcp->seq) << std::endl;
 }
 
+// Preallocated SYN-ACK packet; only the variable fields are patched on each send
+static pkt::PacketBuilder syn_ack_builder(pkt::SYN_ACK_TEMPLATE);
+
 void send_syn_ack(int sock, struct sockaddr_in *client_addr, struct tcphdr *tcp) {
-    char packet[sizeof(struct iphdr) + sizeof(struct tcphdr)];
-    memset(packet, 0, sizeof(packet));
-
-    struct iphdr *ip = (struct iphdr *)packet;
-    struct tcphdr *tcp_response = (struct tcphdr *)(packet + sizeof(struct iphdr));
-
-    // Fill IP header
-    ip->ihl = 5;
-    ip->version = 4;
-    ip->tos = 0;
-    ip->tot_len = htons(sizeof(packet));
-    ip->id = htons(54321);
-    ip->frag_off = 0;
-    ip->ttl = 64;
-    ip->protocol = IPPROTO_TCP;
-    ip->saddr = client_addr->sin_addr.s_addr;
-    ip->daddr = inet_addr("127.0.0.1");  // Server address
-
-    // Fill TCP header
-    tcp_response->source = tcp->dest;
-    tcp_response->dest = tcp->source;
-    tcp_response->seq = htonl(400);
-    tcp_response->ack_seq = htonl(ntohl(tcp->seq) + 1);
-    tcp_response->doff = 5;
-    tcp_response->syn = 1;
-    tcp_response->ack = 1;
-    tcp_response->window = htons(8192);
-    tcp_response->check = 0;  // Kernel will compute the checksum
+    // Patch addresses, ports and numbers into the prebuilt SYN-ACK packet
+    const char *packet = syn_ack_builder.build(client_addr->sin_addr.s_addr,
+                                               htonl(INADDR_LOOPBACK),  // Server address
+                                               ntohs(tcp->dest),
+                                               ntohs(tcp->source),
+                                               400,
+                                               ntohl(tcp->seq) + 1);
 
     // Send packet
-    if (sendto(sock, packet, sizeof(packet), 0, (struct sockaddr *)client_addr, sizeof(*client_addr)) < 0) {
+    if (sendto(sock, packet, syn_ack_builder.size(), 0, (struct sockaddr *)client_addr, sizeof(*client_addr)) < 0) {
         perror("sendto() failed");
     } else {
+        trace::record(syn_ack_builder.ip(), syn_ack_builder.tcp());
         std::cout << "[+] Sent SYN-ACK" << std::endl;
     }
 }
@@ -88,7 +73,9 @@ void receive_syn() {
         // Only process packets for the correct destination port
         if (ntohs(tcp->dest) != SERVER_PORT) continue;
 
-        print_tcp_flags(tcp);
+        trace::record(ip, tcp);
+        if (trace::verbosity() >= trace::PRINT)
+            print_tcp_flags(tcp);
 
         if (tcp->syn == 1 && tcp->ack == 0 && ntohl(tcp->seq) == 200) {
             std::cout << "[+] Received SYN from " << inet_ntoa(source_addr.sin_addr) << std::endl;
@@ -104,7 +91,11 @@ void receive_syn() {
     close(sock);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    if (!trace::configure(argc, argv)) {
+        return 1;
+    }
+
     std::cout << "[+] Server listening on port " << SERVER_PORT << "..." << std::endl;
     receive_syn();
     return 0;
@@ -0,0 +1,318 @@
+#include "async_dvr.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <thread>
+#include <tuple>
+#include "ecmp.h"
+
+using namespace std;
+
+namespace {
+
+using SimTime = int64_t;   // Nanoseconds of simulated time
+const SimTime NEVER = INT64_MAX / 4;
+
+// Link latency rounded to whole nanoseconds
+SimTime linkLatency(int weight, double nsPerCost) {
+    return llround(weight * nsPerCost);
+}
+
+// One route entry of a distance-vector message. A message from one router to a
+// neighbour is the group of entries with the same time, receiver and sender.
+struct Update {
+    SimTime time;   // Arrival at the receiver
+    int to, from;
+    int dest;       // Index into the destination list
+    Dist cost;      // Receiver's cost to dest through the sender
+
+    bool operator>(const Update& o) const {
+        return tie(time, to, from, dest) > tie(o.time, o.to, o.from, o.dest);
+    }
+};
+
+class Barrier {
+public:
+    explicit Barrier(int count) : count_(count) {}
+
+    void wait() {
+        unique_lock<mutex> lock(mutex_);
+        long generation = generation_;
+        if (++waiting_ == count_) {
+            waiting_ = 0;
+            generation_++;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lock, [&] { return generation_ != generation; });
+        }
+    }
+
+private:
+    mutex mutex_;
+    condition_variable cv_;
+    int count_, waiting_ = 0;
+    long generation_ = 0;
+};
+
+struct Partition {
+    int begin, end;   // Routers [begin, end)
+    priority_queue<Update, vector<Update>, greater<Update>> queue;
+    vector<vector<Update>> outbox;   // Per target partition, handed over between windows
+    SimTime nextEvent = NEVER;
+
+    long messages = 0, updates = 0, windows = 0;
+    SimTime lastChange = 0, lastArrival = 0;
+};
+
+class Simulator {
+public:
+    Simulator(const Graph& g, const vector<int>& dests, int parts, double usPerCost);
+
+    void run();
+
+    Dist cost(int router, int d) const { return best_[static_cast<size_t>(router) * dests_.size() + d]; }
+    int nextHop(int router, int d) const { return via_[static_cast<size_t>(router) * dests_.size() + d]; }
+    const vector<Partition>& partitions() const { return parts_; }
+    SimTime lookahead() const { return lookahead_; }
+    long crossLinks() const { return crossLinks_; }
+
+private:
+    SimTime latency(int weight) const { return linkLatency(weight, nsPerCost_); }
+    void worker(int p);
+    void announce(Partition& part, int router, SimTime now, const vector<int>& changed);
+    void deliver(Partition& part, const Update& u);
+    void processWindow(Partition& part, SimTime windowEnd);
+
+    const Graph& g_;
+    const vector<int>& dests_;
+    double nsPerCost_;
+    vector<Dist> best_;    // [router * dests + d]
+    vector<int> via_;
+    vector<int> partOf_;
+    vector<Partition> parts_;
+    SimTime lookahead_ = NEVER;
+    long crossLinks_ = 0;
+    Barrier barrier_;
+};
+
+Simulator::Simulator(const Graph& g, const vector<int>& dests, int parts, double usPerCost)
+    : g_(g), dests_(dests), nsPerCost_(usPerCost * 1000), best_(static_cast<size_t>(g.n) * dests.size(), UNREACHABLE),
+      via_(best_.size(), -1), partOf_(g.n), parts_(parts), barrier_(parts) {
+    for (int p = 0; p < parts; ++p) {
+        parts_[p].begin = static_cast<long>(g.n) * p / parts;
+        parts_[p].end = static_cast<long>(g.n) * (p + 1) / parts;
+        parts_[p].outbox.resize(parts);
+        fill(partOf_.begin() + parts_[p].begin, partOf_.begin() + parts_[p].end, p);
+    }
+    for (int u = 0; u < g.n; ++u) {
+        for (int e = g.offset[u]; e < g.offset[u + 1]; ++e) {
+            if (partOf_[u] == partOf_[g.target[e]]) continue;
+            crossLinks_++;
+            lookahead_ = min(lookahead_, latency(g.weight[e]));
+        }
+    }
+}
+
+void Simulator::deliver(Partition& part, const Update& u) {
+    int p = partOf_[u.to];
+    if (&parts_[p] == &part) part.queue.push(u);
+    else part.outbox[p].push_back(u);
+}
+
+// Send the changed routes of router to every neighbour that can use them: the
+// routers with a link towards it. Split horizon: a route is not offered back to
+// its own next hop, which could only use it for a loop.
+void Simulator::announce(Partition& part, int router, SimTime now, const vector<int>& changed) {
+    size_t row = static_cast<size_t>(router) * dests_.size();
+    for (int e = g_.roffset[router]; e < g_.roffset[router + 1]; ++e) {
+        int neighbour = g_.source[e];
+        SimTime arrival = now + latency(g_.rweight[e]);
+        bool sent = false;
+        for (int d : changed) {
+            if (via_[row + d] == neighbour) continue;
+            deliver(part, {arrival, neighbour, router, d, best_[row + d] + g_.rweight[e]});
+            sent = true;
+        }
+        part.messages += sent;
+    }
+}
+
+void Simulator::processWindow(Partition& part, SimTime windowEnd) {
+    vector<int> changed;
+    while (!part.queue.empty() && part.queue.top().time < windowEnd) {
+        // Apply the whole message, then answer with one message per neighbour
+        SimTime now = part.queue.top().time;
+        int router = part.queue.top().to;
+        size_t row = static_cast<size_t>(router) * dests_.size();
+        changed.clear();
+        while (!part.queue.empty() && part.queue.top().time == now && part.queue.top().to == router) {
+            Update u = part.queue.top();
+            part.queue.pop();
+            part.updates++;
+            if (u.cost >= best_[row + u.dest]) continue;
+            if (find(changed.begin(), changed.end(), u.dest) == changed.end()) changed.push_back(u.dest);
+            best_[row + u.dest] = u.cost;
+            via_[row + u.dest] = u.from;
+        }
+        part.lastArrival = now;
+        if (changed.empty()) continue;
+        part.lastChange = now;
+        announce(part, router, now, changed);
+    }
+}
+
+void Simulator::worker(int p) {
+    Partition& part = parts_[p];
+
+    // At time 0 each destination knows the route to itself and tells its neighbours
+    for (int d = 0; d < static_cast<int>(dests_.size()); ++d) {
+        int router = dests_[d];
+        if (partOf_[router] != p) continue;
+        best_[static_cast<size_t>(router) * dests_.size() + d] = 0;
+        announce(part, router, 0, {d});
+    }
+
+    while (true) {
+        // Take over the messages other partitions sent here during the last window
+        barrier_.wait();
+        for (Partition& other : parts_) {
+            for (const Update& u : other.outbox[p]) part.queue.push(u);
+            other.outbox[p].clear();
+        }
+        part.nextEvent = part.queue.empty() ? NEVER : part.queue.top().time;
+        barrier_.wait();
+
+        // Every thread computes the same window; skip straight to the next event
+        SimTime start = NEVER;
+        for (const Partition& other : parts_) start = min(start, other.nextEvent);
+        if (start == NEVER) break;
+        part.windows++;
+        processWindow(part, lookahead_ == NEVER ? NEVER : start + lookahead_);
+    }
+}
+
+void Simulator::run() {
+    vector<thread> threads;
+    for (int p = 1; p < static_cast<int>(parts_.size()); ++p) threads.emplace_back(&Simulator::worker, this, p);
+    worker(0);
+    for (thread& t : threads) t.join();
+}
+
+// Routers in breadth-first order, so that contiguous ranges are connected regions
+vector<int> bfsOrder(const Graph& g) {
+    vector<int> order;
+    vector<char> seen(g.n, 0);
+    order.reserve(g.n);
+    for (int start = 0; start < g.n; ++start) {
+        if (seen[start]) continue;
+        seen[start] = 1;
+        order.push_back(start);
+        for (size_t i = order.size() - 1; i < order.size(); ++i) {
+            int u = order[i];
+            auto visit = [&](int v) {
+                if (!seen[v]) {
+                    seen[v] = 1;
+                    order.push_back(v);
+                }
+            };
+            for (int e = g.offset[u]; e < g.offset[u + 1]; ++e) visit(g.target[e]);
+            for (int e = g.roffset[u]; e < g.roffset[u + 1]; ++e) visit(g.source[e]);
+        }
+    }
+    return order;
+}
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int runAsyncDvr(const Graph& input, const AsyncDvrOptions& opts) {
+    int threads = opts.threads > 0 ? opts.threads : max(1u, thread::hardware_concurrency());
+    threads = max(1, min(threads, input.n));
+
+    // Renumber routers in BFS order; partitions are then contiguous ranges
+    vector<int> order = bfsOrder(input), newId(input.n);
+    for (int i = 0; i < input.n; ++i) newId[order[i]] = i;
+    vector<Edge> edges;
+    edges.reserve(input.edgeCount());
+    for (int u = 0; u < input.n; ++u)
+        for (int e = input.offset[u]; e < input.offset[u + 1]; ++e)
+            edges.push_back({newId[u], newId[input.target[e]], input.weight[e]});
+    Graph g = buildGraph(input.n, move(edges));
+
+    // Messages must take time: a zero latency would also leave no lookahead
+    if (g.edgeCount() > 0) {
+        int cheapest = *min_element(g.weight.begin(), g.weight.end());
+        if (linkLatency(cheapest, opts.usPerCost * 1000) < 1) {
+            cerr << "Error: --us-per-cost " << opts.usPerCost << " rounds the latency of cost-" << cheapest
+                 << " links to 0 ns; use at least " << 0.0005 / cheapest << endl;
+            return 1;
+        }
+    }
+
+    int destCount = opts.destinations > 0 ? min(opts.destinations, g.n) : (g.n <= 2000 ? g.n : 64);
+    vector<int> dests(g.n);
+    iota(dests.begin(), dests.end(), 0);
+    if (destCount < g.n) {
+        mt19937 rng(opts.seed + 4);
+        shuffle(dests.begin(), dests.end(), rng);
+        dests.resize(destCount);
+    }
+
+    Simulator sim(g, dests, threads, opts.usPerCost);
+    cout << "Topology: " << g.n << " nodes, " << g.edgeCount() << " links, routing to " << destCount
+         << " destinations\n";
+    cout << "Partitions: " << threads << ", " << sim.crossLinks() << " cross-partition links, lookahead ";
+    if (sim.lookahead() == NEVER) cout << "unbounded\n";
+    else cout << sim.lookahead() / 1000.0 << " us\n";
+
+    auto start = chrono::steady_clock::now();
+    sim.run();
+    double seconds = secondsSince(start);
+
+    long messages = 0, updates = 0, windows = 0;
+    SimTime converged = 0, lastArrival = 0;
+    for (const Partition& part : sim.partitions()) {
+        messages += part.messages;
+        updates += part.updates;
+        windows = max(windows, part.windows);
+        converged = max(converged, part.lastChange);
+        lastArrival = max(lastArrival, part.lastArrival);
+    }
+    cout << "Converged after " << converged / 1e6 << " ms simulated (last message delivered at " << lastArrival / 1e6
+         << " ms)\n";
+    cout << "Messages: " << messages << " carrying " << updates << " route entries, " << windows << " time windows\n";
+    cout << "Simulation: " << seconds << " s wall, " << updates / seconds << " events/s\n";
+
+    // The converged routes must be shortest paths: the right cost, over a next hop
+    // that lies on some shortest path
+    int errors = 0;
+    int checks = min(opts.verifyDestinations, destCount);
+    vector<Dist> dist;
+    vector<NextHopSet> hops;
+    for (int d = 0; d < checks; ++d) {
+        nextHopsToward(g, dests[d], dist, hops);
+        for (int r = 0; r < g.n; ++r) {
+            bool ok = sim.cost(r, d) == dist[r] &&
+                      (r == dests[d] || dist[r] == UNREACHABLE ||
+                       find(hops[r].begin(), hops[r].end(), sim.nextHop(r, d)) != hops[r].end());
+            if (ok) continue;
+            if (errors++ < 10)
+                cerr << "Mismatch: router " << order[r] << " to " << order[dests[d]] << " costs " << sim.cost(r, d)
+                     << ", Dijkstra " << dist[r] << endl;
+        }
+    }
+    if (checks > 0)
+        cout << "Verified " << checks << " destinations against Dijkstra: " << errors << " mismatches\n";
+    return errors ? 1 : 0;
+}
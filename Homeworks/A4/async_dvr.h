@@ -0,0 +1,32 @@
+#ifndef ASYNC_DVR_H
+#define ASYNC_DVR_H
+
+#include "graph.h"
+
+// Asynchronous distance-vector routing as a parallel discrete-event simulation.
+//
+// Unlike simulateDVR's global rounds, every router here acts on its own: when a
+// neighbour's distance vector arrives it updates its routes and, if any improved,
+// sends the changed entries to its neighbours. Messages take the link's latency
+// to arrive. Routers are split into one partition per worker thread (contiguous
+// in breadth-first order, so most links stay inside a partition) and the threads
+// advance in conservative time windows: no message can arrive sooner than the
+// smallest cross-partition link latency (the lookahead), so every event in the
+// window [T, T + lookahead) can be processed without waiting for other threads.
+//
+// Routing state is one entry per (router, destination). To keep that manageable
+// on topologies with hundreds of thousands of routers, the simulation can be
+// limited to a sample of destinations.
+
+struct AsyncDvrOptions {
+    int threads = 0;           // Worker threads, 0: one per core
+    int destinations = 0;      // Destinations to route to, 0: all if n <= 2000, else 64
+    double usPerCost = 1;      // Link latency in microseconds per unit of link cost
+    int verifyDestinations = 8;  // Destinations checked against Dijkstra, 0 to skip
+    unsigned seed = 1;
+};
+
+// Returns the process exit code: non-zero if the converged routes are not shortest paths
+int runAsyncDvr(const Graph& g, const AsyncDvrOptions& opts);
+
+#endif // ASYNC_DVR_H
@@ -0,0 +1,426 @@
+#include "ch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <queue>
+
+using namespace std;
+
+namespace {
+
+// Witness searches stop after settling this many nodes or following this many
+// links; a cut-off search just means an occasional unnecessary shortcut, never a
+// wrong answer
+const int WITNESS_SETTLE_LIMIT = 500;
+const int WITNESS_HOP_LIMIT = 5;
+
+struct DynEdge {
+    int node, weight, mid;
+};
+
+struct Shortcut {
+    int from, to, weight;
+};
+
+// The shrinking graph during preprocessing: out[u]/in[u] hold links between
+// routers that are not contracted yet, shortcuts included. Links to contracted
+// routers are dropped lazily: skipped when met, and removed from a router's lists
+// whenever it is evaluated.
+class Contractor {
+public:
+    explicit Contractor(const Graph& g)
+        : out(g.n), in(g.n), contracted(g.n, 0), deletedNeighbors(g.n, 0), level(g.n, 0),
+          witnessDist(g.n, UNREACHABLE), witnessHops(g.n, 0), mark(g.n, 0) {
+        for (int u = 0; u < g.n; ++u) {
+            for (int e = g.offset[u]; e < g.offset[u + 1]; ++e) {
+                out[u].push_back({g.target[e], g.weight[e], -1});
+                in[g.target[e]].push_back({u, g.weight[e], -1});
+            }
+        }
+    }
+
+    // Importance of v: how much contracting it would grow the graph, how many of its
+    // neighbours are gone already (spreads contraction evenly over the graph) and
+    // how deep in the hierarchy it would sit. The shortcuts found are kept for
+    // contract(v), as long as nothing else is evaluated or contracted in between.
+    int priority(int v) {
+        compact(v);
+        findShortcuts(v);
+        int removed = in[v].size() + out[v].size();
+        return 2 * (static_cast<int>(pending.size()) - removed) + deletedNeighbors[v] + level[v];
+    }
+
+    // Take v out of the remaining graph, bridging it with shortcuts where needed;
+    // returns the number of new links. v's own lists stay as they are.
+    int contract(int v) {
+        if (pendingFor != v) priority(v);
+        int added = 0;
+        for (const Shortcut& s : pending) added += addShortcut(s.from, s.to, s.weight, v);
+        pendingFor = -1;
+
+        contracted[v] = 1;
+        for (const vector<DynEdge>* list : {&out[v], &in[v]}) {
+            for (const DynEdge& e : *list) {
+                if (mark[e.node]) continue;   // Linked both ways, counted once
+                mark[e.node] = 1;
+                deletedNeighbors[e.node]++;
+                level[e.node] = max(level[e.node], level[v] + 1);
+            }
+        }
+        for (const DynEdge& e : out[v]) mark[e.node] = 0;
+        for (const DynEdge& e : in[v]) mark[e.node] = 0;
+        return added;
+    }
+
+    vector<vector<DynEdge>> out, in;
+
+private:
+    void compact(int v) {
+        auto dead = [this](const DynEdge& e) { return contracted[e.node] != 0; };
+        out[v].erase(remove_if(out[v].begin(), out[v].end(), dead), out[v].end());
+        in[v].erase(remove_if(in[v].begin(), in[v].end(), dead), in[v].end());
+    }
+
+    // Shortcuts u -> x for every in-neighbour u and out-neighbour x of v whose only
+    // shortest path is through v
+    void findShortcuts(int v) {
+        pending.clear();
+        pendingFor = v;
+        for (const DynEdge& inEdge : in[v]) {
+            int u = inEdge.node;
+            Dist limit = 0;
+            for (const DynEdge& outEdge : out[v])
+                if (outEdge.node != u) limit = max<Dist>(limit, inEdge.weight + outEdge.weight);
+            if (limit == 0) continue;
+
+            int targets = 0;
+            for (const DynEdge& outEdge : out[v]) {
+                if (outEdge.node == u) continue;
+                mark[outEdge.node] = 1;
+                targets++;
+            }
+            witnessSearch(u, v, limit, targets);
+            for (const DynEdge& outEdge : out[v]) mark[outEdge.node] = 0;
+            for (const DynEdge& outEdge : out[v]) {
+                int x = outEdge.node;
+                Dist via = inEdge.weight + outEdge.weight;
+                if (x != u && witnessDist[x] > via) pending.push_back({u, x, static_cast<int>(via)});
+            }
+        }
+    }
+
+    // Cheapest paths from u that avoid `skip`, up to `limit` or until all `targets`
+    // (the routers flagged in mark) are settled
+    void witnessSearch(int u, int skip, Dist limit, int targets) {
+        for (int t : touched) witnessDist[t] = UNREACHABLE;
+        touched.clear();
+        heap.clear();
+
+        auto later = greater<pair<Dist, int>>();
+        witnessDist[u] = 0;
+        witnessHops[u] = 0;
+        touched.push_back(u);
+        heap.push_back({0, u});
+        int settled = 0;
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), later);
+            auto [d, x] = heap.back();
+            heap.pop_back();
+            if (d > witnessDist[x]) continue;
+            if (d > limit || ++settled > WITNESS_SETTLE_LIMIT) break;
+            if (mark[x] && --targets == 0) break;
+            if (witnessHops[x] == WITNESS_HOP_LIMIT) continue;
+            for (const DynEdge& e : out[x]) {
+                if (e.node == skip || contracted[e.node]) continue;
+                Dist nd = d + e.weight;
+                if (nd < witnessDist[e.node]) {
+                    if (witnessDist[e.node] == UNREACHABLE) touched.push_back(e.node);
+                    witnessDist[e.node] = nd;
+                    witnessHops[e.node] = witnessHops[x] + 1;
+                    heap.push_back({nd, e.node});
+                    push_heap(heap.begin(), heap.end(), later);
+                }
+            }
+        }
+    }
+
+    // Add or cheapen u -> x; false if a link u -> x existed already
+    bool addShortcut(int u, int x, int weight, int mid) {
+        for (DynEdge& e : out[u]) {
+            if (e.node != x) continue;
+            if (e.weight <= weight) return false;
+            e.weight = weight;
+            e.mid = mid;
+            for (DynEdge& r : in[x]) {
+                if (r.node == u) {
+                    r.weight = weight;
+                    r.mid = mid;
+                }
+            }
+            return false;
+        }
+        out[u].push_back({x, weight, mid});
+        in[x].push_back({u, weight, mid});
+        return true;
+    }
+
+    vector<char> contracted;
+    vector<int> deletedNeighbors;
+    vector<int> level;             // Longest chain of contracted routers below this one
+    vector<Dist> witnessDist;      // Valid for the nodes in touched, UNREACHABLE elsewhere
+    vector<int> witnessHops;
+    vector<int> touched;
+    vector<pair<Dist, int>> heap;
+    vector<Shortcut> pending;      // Shortcuts found by the last priority() call
+    int pendingFor = -1;
+    vector<char> mark;             // Scratch flags, all clear between calls
+};
+
+struct HierarchyLink {
+    int owner;   // Node whose search graph entry this is
+    int node, weight, mid;
+};
+
+unsigned nextEpoch(unsigned epoch, SearchSide& a, SearchSide& b) {
+    if (++epoch == 0) {
+        // Stamps wrapped around: invalidate everything explicitly once
+        fill(a.stamp.begin(), a.stamp.end(), 0);
+        fill(b.stamp.begin(), b.stamp.end(), 0);
+        epoch = 1;
+    }
+    a.heap.clear();
+    b.heap.clear();
+    return epoch;
+}
+
+Dist distAt(const SearchSide& s, int v, unsigned epoch) {
+    return s.stamp[v] == epoch ? s.dist[v] : UNREACHABLE;
+}
+
+void reach(SearchSide& s, int v, Dist d, int parent, unsigned epoch) {
+    s.stamp[v] = epoch;
+    s.dist[v] = d;
+    s.parent[v] = parent;
+    s.heap.push_back({d, v});
+    push_heap(s.heap.begin(), s.heap.end(), greater<pair<Dist, int>>());
+}
+
+pair<Dist, int> popMin(SearchSide& s) {
+    pop_heap(s.heap.begin(), s.heap.end(), greater<pair<Dist, int>>());
+    pair<Dist, int> top = s.heap.back();
+    s.heap.pop_back();
+    return top;
+}
+
+Dist topKey(const SearchSide& s) {
+    return s.heap.empty() ? UNREACHABLE : s.heap.front().first;
+}
+
+// Node sequence src .. meet .. dest from the parent pointers of both searches
+vector<int> meetingChain(const SearchSide& fwd, const SearchSide& bwd, int meet) {
+    vector<int> chain;
+    for (int v = meet; v != -1; v = fwd.parent[v]) chain.push_back(v);
+    reverse(chain.begin(), chain.end());
+    for (int v = bwd.parent[meet]; v != -1; v = bwd.parent[v]) chain.push_back(v);
+    return chain;
+}
+
+} // namespace
+
+ContractionHierarchy::ContractionHierarchy(const Graph& g) : n_(g.n), rank_(g.n, -1) {
+    auto start = chrono::steady_clock::now();
+    Contractor c(g);
+
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+    vector<int> prio(n_);
+    for (int v = 0; v < n_; ++v) {
+        prio[v] = c.priority(v);
+        pq.push({prio[v], v});
+    }
+
+    vector<HierarchyLink> upLinks, downLinks;
+    int nextRank = 0;
+    while (!pq.empty()) {
+        auto [p, v] = pq.top();
+        pq.pop();
+        if (rank_[v] != -1 || p != prio[v]) continue;   // Contracted or stale entry
+
+        // Lazy update: priorities drift as the graph shrinks, so they are only
+        // recomputed here, when a router comes up for contraction
+        int current = c.priority(v);
+        if (current > p && !pq.empty() && current > pq.top().first) {
+            prio[v] = current;
+            pq.push({current, v});
+            continue;
+        }
+
+        // Every link v still has goes to a router contracted later, i.e. up the hierarchy
+        for (const DynEdge& e : c.out[v]) upLinks.push_back({v, e.node, e.weight, e.mid});
+        for (const DynEdge& e : c.in[v]) downLinks.push_back({v, e.node, e.weight, e.mid});
+        shortcuts_ += c.contract(v);
+        rank_[v] = nextRank++;
+    }
+
+    order_.resize(n_);
+    for (int v = 0; v < n_; ++v) order_[rank_[v]] = v;
+
+    // The search graphs number routers by rank: the top of the hierarchy, which
+    // almost every query visits, then sits together in memory
+    auto toSearchGraph = [this](vector<HierarchyLink>& links, SearchGraph& sg) {
+        for (HierarchyLink& l : links) {
+            l.owner = rank_[l.owner];
+            l.node = rank_[l.node];
+            if (l.mid != -1) l.mid = rank_[l.mid];
+        }
+        sort(links.begin(), links.end(), [](const HierarchyLink& a, const HierarchyLink& b) {
+            return a.owner != b.owner ? a.owner < b.owner : a.node < b.node;
+        });
+        sg.offset.assign(n_ + 1, 0);
+        for (const HierarchyLink& l : links) {
+            sg.offset[l.owner + 1]++;
+            sg.node.push_back(l.node);
+            sg.weight.push_back(l.weight);
+            sg.mid.push_back(l.mid);
+        }
+        for (int i = 0; i < n_; ++i) sg.offset[i + 1] += sg.offset[i];
+    };
+    toSearchGraph(upLinks, up_);
+    toSearchGraph(downLinks, down_);
+
+    buildSeconds_ = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void ContractionHierarchy::findLink(int a, int b, int& weight, int& mid) const {
+    // a -> b is stored with the lower-ranked endpoint
+    const SearchGraph& sg = b > a ? up_ : down_;
+    int owner = b > a ? a : b, other = b > a ? b : a;
+    auto first = sg.node.begin() + sg.offset[owner], last = sg.node.begin() + sg.offset[owner + 1];
+    auto it = lower_bound(first, last, other);
+    weight = sg.weight[it - sg.node.begin()];
+    mid = sg.mid[it - sg.node.begin()];
+}
+
+void ContractionHierarchy::unpack(int a, int b, vector<int>& path) const {
+    // Appends the original route a -> b, without a itself
+    int weight, mid;
+    findLink(a, b, weight, mid);
+    if (mid == -1) {
+        path.push_back(order_[b]);
+        return;
+    }
+    unpack(a, mid, path);
+    unpack(mid, b, path);
+}
+
+ChQuery::ChQuery(const ContractionHierarchy& ch) : ch_(ch), fwd_(ch.n_), bwd_(ch.n_) {}
+
+PathResult ChQuery::query(int src, int dest, bool withPath) {
+    PathResult result;
+    if (src == dest) {
+        result.cost = 0;
+        result.path = {src};
+        return result;
+    }
+
+    epoch_ = nextEpoch(epoch_, fwd_, bwd_);
+    reach(fwd_, ch_.rank_[src], 0, -1, epoch_);
+    reach(bwd_, ch_.rank_[dest], 0, -1, epoch_);
+
+    // Forward search climbs `up` links from src; backward search climbs `down` links
+    // from dest. Each side stops once its queue cannot beat the best meeting point.
+    Dist best = UNREACHABLE;
+    int meet = -1;
+    const auto& up = ch_.up_;
+    const auto& down = ch_.down_;
+    while (true) {
+        bool fwdLive = topKey(fwd_) < best, bwdLive = topKey(bwd_) < best;
+        if (!fwdLive && !bwdLive) break;
+        bool forward = fwdLive && (!bwdLive || topKey(fwd_) <= topKey(bwd_));
+        SearchSide& side = forward ? fwd_ : bwd_;
+        SearchSide& other = forward ? bwd_ : fwd_;
+        const auto& relaxGraph = forward ? up : down;
+        const auto& stallGraph = forward ? down : up;
+
+        auto [d, u] = popMin(side);
+        if (d > distAt(side, u, epoch_)) continue;
+        result.settled++;
+
+        Dist there = distAt(other, u, epoch_);
+        if (there != UNREACHABLE && d + there < best) {
+            best = d + there;
+            meet = u;
+        }
+
+        // Stall-on-demand: if a higher router already reaches u more cheaply, u is not
+        // on any shortest up-path and need not be expanded
+        bool stalled = false;
+        for (int e = stallGraph.offset[u]; e < stallGraph.offset[u + 1] && !stalled; ++e) {
+            Dist via = distAt(side, stallGraph.node[e], epoch_);
+            stalled = via != UNREACHABLE && via + stallGraph.weight[e] < d;
+        }
+        if (stalled) continue;
+
+        for (int e = relaxGraph.offset[u]; e < relaxGraph.offset[u + 1]; ++e) {
+            int v = relaxGraph.node[e];
+            Dist nd = d + relaxGraph.weight[e];
+            if (nd < distAt(side, v, epoch_)) reach(side, v, nd, u, epoch_);
+        }
+    }
+
+    if (meet == -1) return result;
+    result.cost = best;
+    if (withPath) {
+        vector<int> chain = meetingChain(fwd_, bwd_, meet);
+        result.path.push_back(src);
+        for (size_t i = 0; i + 1 < chain.size(); ++i) ch_.unpack(chain[i], chain[i + 1], result.path);
+    }
+    return result;
+}
+
+BidirectionalDijkstra::BidirectionalDijkstra(const Graph& g) : g_(g), fwd_(g.n), bwd_(g.n) {}
+
+PathResult BidirectionalDijkstra::query(int src, int dest, bool withPath) {
+    PathResult result;
+    if (src == dest) {
+        result.cost = 0;
+        result.path = {src};
+        return result;
+    }
+
+    epoch_ = nextEpoch(epoch_, fwd_, bwd_);
+    reach(fwd_, src, 0, -1, epoch_);
+    reach(bwd_, dest, 0, -1, epoch_);
+
+    // Stop once the two frontiers together cannot beat the best path found
+    Dist best = UNREACHABLE;
+    int meet = -1;
+    while (!fwd_.heap.empty() && !bwd_.heap.empty() && topKey(fwd_) + topKey(bwd_) < best) {
+        bool forward = topKey(fwd_) <= topKey(bwd_);
+        SearchSide& side = forward ? fwd_ : bwd_;
+        SearchSide& other = forward ? bwd_ : fwd_;
+        const vector<int>& offset = forward ? g_.offset : g_.roffset;
+        const vector<int>& node = forward ? g_.target : g_.source;
+        const vector<int>& weight = forward ? g_.weight : g_.rweight;
+
+        auto [d, u] = popMin(side);
+        if (d > distAt(side, u, epoch_)) continue;
+        result.settled++;
+
+        for (int e = offset[u]; e < offset[u + 1]; ++e) {
+            int v = node[e];
+            Dist nd = d + weight[e];
+            if (nd < distAt(side, v, epoch_)) reach(side, v, nd, u, epoch_);
+            Dist there = distAt(other, v, epoch_);
+            if (there != UNREACHABLE && nd + there < best) {
+                best = nd + there;
+                meet = v;
+            }
+        }
+    }
+
+    if (meet == -1) return result;
+    result.cost = best;
+    if (withPath) result.path = meetingChain(fwd_, bwd_, meet);
+    return result;
+}
@@ -0,0 +1,94 @@
+#ifndef CH_H
+#define CH_H
+
+#include <utility>
+#include <vector>
+#include "graph.h"
+
+// Point-to-point shortest path queries.
+//
+// ContractionHierarchy preprocesses the graph once: routers are "contracted" one by
+// one in order of importance, adding shortcut links wherever removing a router
+// would break a shortest path. A query then runs two tiny Dijkstra searches (from
+// the source forwards, from the destination backwards) that only ever move up the
+// hierarchy, and meet at the most important router on the path. Shortcuts remember
+// the router they bypass, so the full path can be unpacked afterwards.
+//
+// BidirectionalDijkstra needs no preprocessing and is the fallback when building
+// the hierarchy is not worth it (few queries, or a graph that keeps changing).
+//
+// Query objects keep per-search scratch state, so use one per thread.
+
+struct PathResult {
+    Dist cost = UNREACHABLE;
+    std::vector<int> path;   // Source to destination inclusive; empty if unreachable
+    int settled = 0;         // Nodes taken off the priority queues, a measure of work
+};
+
+// Scratch state of one search direction, reused across queries
+struct SearchSide {
+    std::vector<Dist> dist;
+    std::vector<int> parent;
+    std::vector<unsigned> stamp;   // dist/parent are valid only where stamp == the query's epoch
+    std::vector<std::pair<Dist, int>> heap;
+
+    explicit SearchSide(int n) : dist(n), parent(n), stamp(n, 0) {}
+};
+
+class ContractionHierarchy {
+public:
+    explicit ContractionHierarchy(const Graph& g);
+
+    int nodeCount() const { return n_; }
+    int shortcutCount() const { return shortcuts_; }
+    double buildSeconds() const { return buildSeconds_; }
+
+private:
+    friend class ChQuery;
+
+    // Upward search graphs in CSR form, with routers numbered by rank. up holds
+    // u -> v with v > u; down holds, for each v, the links u -> v with u > v
+    // (searched backwards from the destination). mid is the bypassed router of a
+    // shortcut, -1 for an original link.
+    struct SearchGraph {
+        std::vector<int> offset, node, weight, mid;
+    };
+
+    // Cost and bypassed router of the hierarchy link a -> b, all given by rank
+    void findLink(int a, int b, int& weight, int& mid) const;
+    void unpack(int a, int b, std::vector<int>& path) const;
+
+    int n_;
+    int shortcuts_ = 0;
+    double buildSeconds_ = 0;
+    std::vector<int> rank_;    // Router -> rank
+    std::vector<int> order_;   // Rank -> router
+    SearchGraph up_, down_;
+};
+
+class ChQuery {
+public:
+    explicit ChQuery(const ContractionHierarchy& ch);
+
+    // Shortest path cost and route; set withPath = false when only the cost is needed
+    PathResult query(int src, int dest, bool withPath = true);
+
+private:
+    const ContractionHierarchy& ch_;
+    SearchSide fwd_, bwd_;
+    unsigned epoch_ = 0;
+};
+
+class BidirectionalDijkstra {
+public:
+    explicit BidirectionalDijkstra(const Graph& g);
+
+    PathResult query(int src, int dest, bool withPath = true);
+
+private:
+    const Graph& g_;
+    SearchSide fwd_, bwd_;
+    unsigned epoch_ = 0;
+};
+
+#endif // CH_H
@@ -0,0 +1,115 @@
+#include "ecmp.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+using namespace std;
+
+namespace {
+
+using HeapEntry = pair<Dist, int>;
+using MinHeap = priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry>>;
+
+// Final mixing step of MurmurHash3: every input bit affects every output bit
+uint32_t mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+} // namespace
+
+bool NextHopSet::insert(int hop) {
+    const int* first = begin();
+    const int* pos = lower_bound(first, end(), hop);
+    if (pos != end() && *pos == hop) return false;
+    int at = pos - first;
+
+    if (size_ < INLINE) {
+        copy_backward(inline_ + at, inline_ + size_, inline_ + size_ + 1);
+        inline_[at] = hop;
+    } else {
+        if (size_ == INLINE) spill_.assign(inline_, inline_ + INLINE);
+        spill_.insert(spill_.begin() + at, hop);
+    }
+    size_++;
+    return true;
+}
+
+bool NextHopSet::merge(const NextHopSet& other) {
+    bool grew = false;
+    for (int hop : other) grew |= insert(hop);
+    return grew;
+}
+
+void dijkstraNextHops(const Graph& g, int src, vector<Dist>& dist, vector<NextHopSet>& hops, bool allEqualCost) {
+    dist.assign(g.n, UNREACHABLE);
+    hops.assign(g.n, NextHopSet());
+    dist[src] = 0;
+
+    // Link costs are positive, so every equal-cost predecessor of v is settled, and
+    // its hops final, before v is
+    MinHeap pq;
+    pq.push({0, src});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u])
+            continue;
+        for (int e = g.offset[u]; e < g.offset[u + 1]; ++e) {
+            int v = g.target[e];
+            Dist newDist = d + g.weight[e];
+            NextHopSet direct;
+            if (u == src) direct.insert(v);
+            const NextHopSet& via = u == src ? direct : hops[u];
+            if (newDist < dist[v]) {
+                dist[v] = newDist;
+                hops[v] = via;
+                pq.push({newDist, v});
+            } else if (allEqualCost && newDist == dist[v]) {
+                hops[v].merge(via);
+            }
+        }
+    }
+}
+
+void nextHopsToward(const Graph& g, int dest, vector<Dist>& dist, vector<NextHopSet>& hops) {
+    dist.assign(g.n, UNREACHABLE);
+    hops.resize(g.n);
+    for (NextHopSet& h : hops) h.clear();
+    dist[dest] = 0;
+
+    // Search backwards over in-links: reaching u from v means u can forward via v
+    MinHeap pq;
+    pq.push({0, dest});
+    while (!pq.empty()) {
+        auto [d, v] = pq.top();
+        pq.pop();
+        if (d > dist[v])
+            continue;
+        for (int e = g.roffset[v]; e < g.roffset[v + 1]; ++e) {
+            int u = g.source[e];
+            Dist newDist = d + g.rweight[e];
+            if (newDist < dist[u]) {
+                dist[u] = newDist;
+                hops[u].clear();
+                hops[u].insert(v);
+                pq.push({newDist, u});
+            } else if (newDist == dist[u]) {
+                hops[u].insert(v);
+            }
+        }
+    }
+}
+
+uint32_t flowHash(const FlowKey& flow, uint32_t seed) {
+    uint32_t h = mix32(seed ^ 0x9e3779b9);
+    h = mix32(h ^ flow.srcAddr);
+    h = mix32(h ^ flow.dstAddr);
+    h = mix32(h ^ ((static_cast<uint32_t>(flow.srcPort) << 16) | flow.dstPort));
+    return mix32(h ^ flow.protocol);
+}
@@ -0,0 +1,75 @@
+#ifndef ECMP_H
+#define ECMP_H
+
+#include <cstdint>
+#include <vector>
+#include "graph.h"
+
+// Equal-cost multipath (ECMP) routing.
+//
+// Instead of one next hop per destination, a router keeps every neighbour that
+// lies on some shortest path, and spreads traffic over them by hashing each
+// flow's 5-tuple. All packets of a flow hash the same way, so a flow stays on
+// one path and is not reordered.
+
+// Sorted set of next hops. Sets are small (at most the router's degree, usually
+// a handful), so up to INLINE hops live in the object itself and only larger
+// sets, as on high-radix switches, allocate.
+class NextHopSet {
+public:
+    NextHopSet() = default;
+    explicit NextHopSet(int hop) { insert(hop); }
+
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const int* begin() const { return size_ <= INLINE ? inline_ : spill_.data(); }
+    const int* end() const { return begin() + size_; }
+    int operator[](int i) const { return begin()[i]; }
+
+    void clear() {
+        size_ = 0;
+        spill_.clear();
+    }
+    // Returns true if the hop was not in the set yet
+    bool insert(int hop);
+    // Adds all hops of other; returns true if the set grew
+    bool merge(const NextHopSet& other);
+
+private:
+    static const int INLINE = 5;   // Fills the padding before spill_: 48 bytes in all
+
+    int size_ = 0;
+    int inline_[INLINE];
+    std::vector<int> spill_;   // All hops once there are more than INLINE
+};
+
+// Single-source Dijkstra that also returns the first hops from src to every node.
+// With allEqualCost, hops[v] holds every neighbour of src that starts a shortest
+// path to v; without it, only the one found first (as plain LSR does).
+void dijkstraNextHops(const Graph& g, int src, std::vector<Dist>& dist, std::vector<NextHopSet>& hops,
+                      bool allEqualCost);
+
+// Every router's equal-cost next hops towards dest, from one backwards Dijkstra:
+// dist[u] is u's cost to dest and hops[u] its neighbours on a shortest path
+void nextHopsToward(const Graph& g, int dest, std::vector<Dist>& dist, std::vector<NextHopSet>& hops);
+
+struct FlowKey {
+    std::uint32_t srcAddr, dstAddr;
+    std::uint16_t srcPort, dstPort;
+    std::uint8_t protocol;
+};
+
+// Hash of the flow's 5-tuple. Routers should use different seeds: with the same
+// hash everywhere, the flows one router sends to a neighbour all land in the same
+// hash range there too, and the neighbour uses only one of its own next hops
+// (hash polarization).
+std::uint32_t flowHash(const FlowKey& flow, std::uint32_t seed);
+
+// Hash-threshold selection (RFC 2992): the hash space is split into equal ranges,
+// one per next hop, so changing the set moves as few flows as possible.
+// hops must not be empty.
+inline int selectNextHop(const NextHopSet& hops, std::uint32_t hash) {
+    return hops[static_cast<int>((static_cast<std::uint64_t>(hash) * hops.size()) >> 32)];
+}
+
+#endif // ECMP_H
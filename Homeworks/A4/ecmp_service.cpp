@@ -0,0 +1,127 @@
+#include "ecmp_service.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include "ecmp.h"
+
+using namespace std;
+
+namespace {
+
+struct Flow {
+    int src, dest;
+    FlowKey key;
+};
+
+enum Policy { SINGLE_PATH, SAME_SEED, ROUTER_SEED, POLICIES };
+const char* const POLICY_NAMES[POLICIES] = {"Single path", "ECMP, same hash seed", "ECMP, per-router seed"};
+
+// Index of the link u -> v in the graph's CSR arrays
+int linkIndex(const Graph& g, int u, int v) {
+    auto first = g.target.begin() + g.offset[u], last = g.target.begin() + g.offset[u + 1];
+    return lower_bound(first, last, v) - g.target.begin();
+}
+
+vector<Flow> randomFlows(int endpoints, long count, mt19937& rng) {
+    uniform_int_distribution<int> node(0, endpoints - 1);
+    uniform_int_distribution<uint32_t> host(0, 0xff);
+    uniform_int_distribution<int> port(1024, 65535);
+    vector<Flow> flows(count);
+    for (Flow& f : flows) {
+        f.src = node(rng);
+        do f.dest = node(rng);
+        while (f.dest == f.src);
+        // Host addresses are built from the router id plus a random host byte
+        f.key.srcAddr = (10u << 24) | (static_cast<uint32_t>(f.src) << 8) | host(rng);
+        f.key.dstAddr = (10u << 24) | (static_cast<uint32_t>(f.dest) << 8) | host(rng);
+        f.key.srcPort = port(rng);
+        f.key.dstPort = port(rng);
+        f.key.protocol = rng() & 1 ? 6 : 17;
+    }
+    sort(flows.begin(), flows.end(), [](const Flow& a, const Flow& b) { return a.dest < b.dest; });
+    return flows;
+}
+
+void printPolicy(const string& name, const vector<long>& load, const vector<char>& usable) {
+    long used = 0, max = 0;
+    double sum = 0, sumSquares = 0, links = 0;
+    for (size_t e = 0; e < load.size(); ++e) {
+        if (load[e] > 0) used++;
+        if (load[e] > max) max = load[e];
+        if (!usable[e]) continue;
+        links++;
+        sum += load[e];
+        sumSquares += static_cast<double>(load[e]) * load[e];
+    }
+    double mean = links ? sum / links : 0;
+    // Jain's fairness index: 1 when all usable links carry the same load
+    double fairness = sumSquares ? sum * sum / (links * sumSquares) : 1;
+    cout << left << setw(24) << name << right << setw(12) << used << setw(12) << max << setw(12) << fixed
+         << setprecision(2) << (mean ? max / mean : 0) << setw(12) << setprecision(3) << fairness << "\n";
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+} // namespace
+
+void runEcmpService(const Graph& g, const EcmpServiceOptions& opts) {
+    int endpoints = opts.endpoints > 0 ? min(opts.endpoints, g.n) : g.n;
+    cout << "Topology: " << g.n << " nodes, " << g.edgeCount() << " links\n";
+    if (endpoints < 2 || opts.flows <= 0) return;
+
+    mt19937 rng(opts.seed + 3);
+    vector<Flow> flows = randomFlows(endpoints, opts.flows, rng);
+    vector<uint32_t> routerSeed(g.n);
+    for (uint32_t& s : routerSeed) s = rng();
+
+    vector<vector<long>> load(POLICIES, vector<long>(g.edgeCount(), 0));
+    vector<char> usable(g.edgeCount(), 0);   // Link lies on a shortest path of some flow
+    long unreachable = 0, hops = 0, choices = 0;
+    vector<Dist> dist;
+    vector<NextHopSet> nextHops;
+    for (size_t i = 0; i < flows.size(); ++i) {
+        // Flows are sorted by destination: one backwards search per destination
+        if (i == 0 || flows[i].dest != flows[i - 1].dest) nextHopsToward(g, flows[i].dest, dist, nextHops);
+        const Flow& f = flows[i];
+        if (dist[f.src] == UNREACHABLE) {
+            unreachable++;
+            continue;
+        }
+
+        uint32_t sameSeedHash = flowHash(f.key, 0);
+        for (int p = 0; p < POLICIES; ++p) {
+            for (int u = f.src; u != f.dest;) {
+                const NextHopSet& set = nextHops[u];
+                int v;
+                if (p == SINGLE_PATH) {
+                    v = set[0];
+                } else if (p == SAME_SEED) {
+                    v = selectNextHop(set, sameSeedHash);
+                } else {
+                    v = selectNextHop(set, flowHash(f.key, routerSeed[u]));
+                    hops++;
+                    choices += set.size() > 1;
+                    for (int h : set) usable[linkIndex(g, u, h)] = 1;
+                }
+                load[p][linkIndex(g, u, v)]++;
+                u = v;
+            }
+        }
+    }
+
+    long routed = flows.size() - unreachable;
+    cout << "Flows: " << flows.size() << " between " << endpoints << " endpoints, " << unreachable << " unreachable, "
+         << fixed << setprecision(2) << (routed ? static_cast<double>(hops) / routed : 0) << " hops on average, "
+         << (hops ? 100.0 * choices / hops : 0) << "% of hops with an equal-cost choice\n";
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+
+    // Max/mean and fairness are over the usable links: those on the shortest paths
+    // hashing could have spread the flows over
+    cout << "\n" << left << setw(24) << "Policy" << right << setw(12) << "Links used" << setw(12) << "Max load"
+         << setw(12) << "Max/mean" << setw(12) << "Fairness" << "\n";
+    for (int p = 0; p < POLICIES; ++p) printPolicy(POLICY_NAMES[p], load[p], usable);
+}
@@ -0,0 +1,18 @@
+#ifndef ECMP_SERVICE_H
+#define ECMP_SERVICE_H
+
+#include "graph.h"
+
+// Load-distribution report of the ECMP mode: routes random flows hop by hop over
+// their equal-cost next hops and reports how evenly the links are loaded, for
+// single-path routing and for flow hashing with and without per-router seeds.
+
+struct EcmpServiceOptions {
+    long flows = 100000;
+    int endpoints = 0;   // Flows run between nodes 0 .. endpoints-1; 0 means all nodes
+    unsigned seed = 1;
+};
+
+void runEcmpService(const Graph& g, const EcmpServiceOptions& opts);
+
+#endif // ECMP_SERVICE_H
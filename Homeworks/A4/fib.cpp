@@ -0,0 +1,214 @@
+#include "fib.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace {
+
+uint32_t prefixMask(int len) {
+    return len == 0 ? 0 : ~uint32_t(0) << (32 - len);
+}
+
+// First hop from src to every node, walking each predecessor chain only once
+vector<int> firstHops(int src, const vector<int>& prev) {
+    int n = prev.size();
+    vector<int> hop(n, -2);   // -2: not computed yet
+    vector<int> chain;
+    hop[src] = src;
+    for (int v = 0; v < n; ++v) {
+        int u = v;
+        while (hop[u] == -2 && prev[u] != -1 && prev[u] != src) {
+            chain.push_back(u);
+            u = prev[u];
+        }
+        int h = hop[u] != -2 ? hop[u] : (prev[u] == src ? u : -1);
+        hop[u] = h;
+        for (int c : chain) hop[c] = h;
+        chain.clear();
+    }
+    return hop;
+}
+
+} // namespace
+
+bool parsePrefix(const string& text, Prefix& prefix) {
+    unsigned a, b, c, d;
+    int len;
+    char dot1, dot2, dot3, slash;
+    stringstream ss(text);
+    if (!(ss >> a >> dot1 >> b >> dot2 >> c >> dot3 >> d >> slash >> len)) return false;
+    if (dot1 != '.' || dot2 != '.' || dot3 != '.' || slash != '/') return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255 || len < 0 || len > 32) return false;
+    prefix.addr = ((a << 24) | (b << 16) | (c << 8) | d) & prefixMask(len);
+    prefix.len = len;
+    return true;
+}
+
+string formatPrefix(const Prefix& prefix) {
+    stringstream ss;
+    ss << (prefix.addr >> 24) << "." << ((prefix.addr >> 16) & 0xff) << "." << ((prefix.addr >> 8) & 0xff) << "."
+       << (prefix.addr & 0xff) << "/" << prefix.len;
+    return ss.str();
+}
+
+vector<PrefixOwner> readPrefixFile(const string& filename, int nodeCount) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        exit(1);
+    }
+
+    vector<PrefixOwner> owners;
+    string line;
+    int lineNo = 0;
+    while (getline(file, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+        stringstream ss(line);
+        string text;
+        if (!(ss >> text)) continue;
+        PrefixOwner owner;
+        if (!parsePrefix(text, owner.prefix) || !(ss >> owner.node) || owner.node < 0 || owner.node >= nodeCount) {
+            cerr << "Error: " << filename << ":" << lineNo << ": expected \"a.b.c.d/len node\" with node < "
+                 << nodeCount << endl;
+            exit(1);
+        }
+        owners.push_back(owner);
+    }
+    return owners;
+}
+
+vector<PrefixOwner> generatePrefixes(int n, int perNode, unsigned seed) {
+    mt19937 rng(seed);
+    // Share of each prefix length, roughly as in a BGP table
+    const int lengths[] = {16, 18, 20, 22, 24, 26, 28, 30};
+    discrete_distribution<int> pickLength({5, 5, 10, 15, 50, 8, 5, 2});
+    uniform_int_distribution<uint32_t> anyAddr(1u << 24, (224u << 24) - 1);   // Unicast space
+    bernoulli_distribution carve(0.2);
+
+    vector<PrefixOwner> owners;
+    owners.reserve(static_cast<size_t>(n) * perNode);
+    for (int node = 0; node < n; ++node) {
+        for (int i = 0; i < perNode; ++i) {
+            int len = lengths[pickLength(rng)];
+            uint32_t addr = anyAddr(rng);
+            if (!owners.empty() && carve(rng)) {
+                // More specific route inside another router's block
+                const Prefix& outer = owners[uniform_int_distribution<size_t>(0, owners.size() - 1)(rng)].prefix;
+                if (outer.len < len) addr = outer.addr | (addr & ~prefixMask(outer.len));
+            }
+            owners.push_back({{addr & prefixMask(len), len}, node});
+        }
+    }
+    return owners;
+}
+
+vector<Route> buildRoutes(int src, const vector<PrefixOwner>& owners, const vector<Dist>& dist,
+                          const vector<int>& prev) {
+    vector<int> hop = firstHops(src, prev);
+
+    // Closest reachable owner of each distinct prefix
+    unordered_map<uint64_t, size_t> index;
+    vector<Route> routes;
+    vector<Dist> cost;
+    for (const PrefixOwner& o : owners) {
+        if (dist[o.node] == UNREACHABLE) continue;
+        uint64_t key = (static_cast<uint64_t>(o.prefix.addr) << 6) | o.prefix.len;
+        auto [it, added] = index.try_emplace(key, routes.size());
+        if (added) {
+            routes.push_back({o.prefix, hop[o.node]});
+            cost.push_back(dist[o.node]);
+        } else if (dist[o.node] < cost[it->second]) {
+            routes[it->second].nextHop = hop[o.node];
+            cost[it->second] = dist[o.node];
+        }
+    }
+    return routes;
+}
+
+template <typename T>
+T* HugePageAllocator<T>::allocate(size_t count) {
+    void* p = mmap(nullptr, count * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw bad_alloc();
+    madvise(p, count * sizeof(T), MADV_HUGEPAGE);
+    return static_cast<T*>(p);
+}
+
+template <typename T>
+void HugePageAllocator<T>::deallocate(T* p, size_t count) {
+    munmap(p, count * sizeof(T));
+}
+
+template struct HugePageAllocator<uint32_t>;
+
+Dir248Fib::Dir248Fib(const vector<Route>& routes) : tbl24_(1 << 24, 0), nextHops_{NO_ROUTE} {
+    // Install shorter prefixes first so longer ones simply overwrite them
+    vector<Route> sorted = routes;
+    stable_sort(sorted.begin(), sorted.end(), [](const Route& a, const Route& b) { return a.prefix.len < b.prefix.len; });
+
+    unordered_map<int, uint32_t> hopIndex;
+    for (const Route& r : sorted) {
+        auto [it, added] = hopIndex.try_emplace(r.nextHop, nextHops_.size());
+        if (added) {
+            if (nextHops_.size() >= EXTENDED) {
+                cerr << "Error: Too many distinct next hops for DIR-24-8" << endl;
+                exit(1);
+            }
+            nextHops_.push_back(r.nextHop);
+        }
+        uint32_t value = it->second;
+
+        uint32_t first24 = r.prefix.addr >> 8;
+        if (r.prefix.len <= 24) {
+            // No tbl8 group exists yet: they are only created by longer prefixes
+            fill(tbl24_.begin() + first24, tbl24_.begin() + first24 + (1u << (24 - r.prefix.len)), value);
+            continue;
+        }
+        uint32_t& entry = tbl24_[first24];
+        if (!(entry & EXTENDED)) {
+            size_t groups = tbl8_.size() >> 8;
+            if (groups >= EXTENDED) {
+                cerr << "Error: Too many prefixes longer than /24 for DIR-24-8" << endl;
+                exit(1);
+            }
+            // The new group inherits the /24's current route
+            uint32_t group = static_cast<uint32_t>(groups);
+            tbl8_.resize(tbl8_.size() + 256, entry);
+            entry = group | EXTENDED;
+        }
+        size_t base = (static_cast<size_t>(entry & ~EXTENDED) << 8) | (r.prefix.addr & 0xff);
+        fill(tbl8_.begin() + base, tbl8_.begin() + base + (1u << (32 - r.prefix.len)), value);
+    }
+}
+
+void Dir248Fib::lookupBatch(const uint32_t* addrs, int* nextHops, size_t count) const {
+    const size_t AHEAD = 16;
+    for (size_t i = 0; i < count; ++i) {
+        if (i + AHEAD < count) __builtin_prefetch(&tbl24_[addrs[i + AHEAD] >> 8]);
+        nextHops[i] = lookup(addrs[i]);
+    }
+}
+
+size_t Dir248Fib::memoryBytes() const {
+    return (tbl24_.size() + tbl8_.size()) * sizeof(uint32_t) + nextHops_.size() * sizeof(int);
+}
+
+ReferenceFib::ReferenceFib(const vector<Route>& routes) {
+    for (const Route& r : routes) byLength_[r.prefix.len][r.prefix.addr] = r.nextHop;
+    for (int len = 32; len >= 0; --len)
+        if (!byLength_[len].empty()) lengths_.push_back(len);
+}
+
+int ReferenceFib::lookup(uint32_t addr) const {
+    for (int len : lengths_) {
+        auto it = byLength_[len].find(addr & prefixMask(len));
+        if (it != byLength_[len].end()) return it->second;
+    }
+    return Dir248Fib::NO_ROUTE;
+}
@@ -0,0 +1,116 @@
+#ifndef FIB_H
+#define FIB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "graph.h"
+
+// Forwarding tables for the data plane.
+//
+// Routers own IPv4 prefixes. A node's FIB maps every prefix to the next hop
+// towards its owner, and forwarding a packet means finding the longest prefix
+// that matches the destination address. Dir248Fib compiles the FIB into the
+// DIR-24-8 layout: a 2^24 entry table indexed by the top 24 address bits,
+// plus 256-entry second-level groups for the few /24s that hold longer
+// prefixes. A lookup is then one memory access, or two for those /24s.
+
+struct Prefix {
+    std::uint32_t addr = 0;   // Host bits are zero
+    int len = 0;
+};
+
+struct PrefixOwner {
+    Prefix prefix;
+    int node;
+};
+
+// One route of a node's FIB. nextHop is the neighbour to forward to, or the node
+// itself if it owns the prefix.
+struct Route {
+    Prefix prefix;
+    int nextHop;
+};
+
+// "a.b.c.d/len"; host bits are cleared. Returns false if the text is not a prefix.
+bool parsePrefix(const std::string& text, Prefix& prefix);
+std::string formatPrefix(const Prefix& prefix);
+
+// Prefix file: one "a.b.c.d/len node" per line, '#' starts a comment
+std::vector<PrefixOwner> readPrefixFile(const std::string& filename, int nodeCount);
+
+// perNode prefixes for each of n routers. Lengths follow a BGP-table-like mix (mostly
+// /24, some shorter, a few longer), and some prefixes are carved out of another
+// router's block, so longest-prefix matching matters.
+std::vector<PrefixOwner> generatePrefixes(int n, int perNode, unsigned seed);
+
+// The routes of node src from its LSR tables. If several routers announce the same
+// prefix, the closest one wins; prefixes of unreachable routers are left out.
+std::vector<Route> buildRoutes(int src, const std::vector<PrefixOwner>& owners, const std::vector<Dist>& dist,
+                               const std::vector<int>& prev);
+
+// Allocator for the big lookup tables: backs them with transparent huge pages where
+// the kernel allows it, so random lookups do not also miss the TLB on every access
+template <typename T>
+struct HugePageAllocator {
+    using value_type = T;
+
+    HugePageAllocator() = default;
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(std::size_t count);
+    void deallocate(T* p, std::size_t count);
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U>&) const { return false; }
+};
+
+class Dir248Fib {
+public:
+    static const int NO_ROUTE = -1;
+
+    explicit Dir248Fib(const std::vector<Route>& routes);
+
+    // Next hop for addr, or NO_ROUTE
+    int lookup(std::uint32_t addr) const {
+        std::uint32_t entry = tbl24_[addr >> 8];
+        if (entry & EXTENDED) entry = tbl8_[(static_cast<std::size_t>(entry & ~EXTENDED) << 8) | (addr & 0xff)];
+        return nextHops_[entry];
+    }
+
+    // Looks up count addresses in order, prefetching the tbl24 entry of the address
+    // 16 positions ahead, so its cache miss overlaps the lookups in between.
+    void lookupBatch(const std::uint32_t* addrs, int* nextHops, std::size_t count) const;
+
+    int groupCount() const { return static_cast<int>(tbl8_.size() >> 8); }
+    std::size_t memoryBytes() const;
+
+private:
+    // Entries are indexes into nextHops_ (0 = no route), or with EXTENDED set the
+    // number of a tbl8 group
+    static const std::uint32_t EXTENDED = 0x80000000;
+
+    std::vector<std::uint32_t, HugePageAllocator<std::uint32_t>> tbl24_;
+    std::vector<std::uint32_t, HugePageAllocator<std::uint32_t>> tbl8_;
+    std::vector<int> nextHops_;
+};
+
+// Straightforward longest-prefix match (one hash probe per prefix length), used to
+// check Dir248Fib and as the baseline of the benchmark
+class ReferenceFib {
+public:
+    explicit ReferenceFib(const std::vector<Route>& routes);
+
+    int lookup(std::uint32_t addr) const;
+
+private:
+    std::unordered_map<std::uint32_t, int> byLength_[33];
+    std::vector<int> lengths_;   // Prefix lengths in use, longest first
+};
+
+#endif // FIB_H
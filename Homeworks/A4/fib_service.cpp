@@ -0,0 +1,139 @@
+#include "fib_service.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "fib.h"
+
+using namespace std;
+
+namespace {
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void printFib(int node, vector<Route> routes) {
+    sort(routes.begin(), routes.end(), [](const Route& a, const Route& b) {
+        return a.prefix.addr != b.prefix.addr ? a.prefix.addr < b.prefix.addr : a.prefix.len < b.prefix.len;
+    });
+    cout << "Node " << node << " FIB:\n";
+    cout << "Prefix\t\tNext Hop\n";
+    for (const Route& r : routes) {
+        cout << formatPrefix(r.prefix) << "\t";
+        if (r.nextHop == node) cout << "local";
+        else cout << r.nextHop;
+        cout << endl;
+    }
+    cout << endl;
+}
+
+// Half the addresses fall inside a routed prefix, half anywhere, so both the
+// hit and the miss paths are exercised
+vector<uint32_t> randomAddresses(const vector<Route>& routes, long count, mt19937& rng) {
+    uniform_int_distribution<uint32_t> any;
+    uniform_int_distribution<size_t> route(0, routes.empty() ? 0 : routes.size() - 1);
+    vector<uint32_t> addrs(count);
+    for (long i = 0; i < count; ++i) {
+        uint32_t a = any(rng);
+        if (!routes.empty() && (i & 1)) {
+            const Prefix& p = routes[route(rng)].prefix;
+            uint32_t host = p.len == 0 ? ~uint32_t(0) : (uint32_t(1) << (32 - p.len)) - 1;
+            a = p.addr | (a & host);
+        }
+        addrs[i] = a;
+    }
+    return addrs;
+}
+
+// Time one pass of `run` over all addresses; run returns a checksum of the next hops
+// so the lookups cannot be optimised away
+template <typename Run>
+void benchmark(const string& name, long count, Run run) {
+    auto start = chrono::steady_clock::now();
+    long checksum = run();
+    double seconds = secondsSince(start);
+    cout << left << setw(22) << name << right << setw(12) << count << setw(12) << fixed << setprecision(2)
+         << seconds * 1e9 / count << setw(12) << count / seconds / 1e6 << setw(16) << checksum << "\n";
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+} // namespace
+
+int runFibService(const Graph& g, const FibServiceOptions& opts) {
+    vector<PrefixOwner> owners = opts.prefixFile.empty() ? generatePrefixes(g.n, opts.prefixesPerNode, opts.seed)
+                                                         : readPrefixFile(opts.prefixFile, g.n);
+    cout << "Topology: " << g.n << " nodes, " << g.edgeCount() << " links, " << owners.size() << " prefixes\n";
+
+    vector<int> nodes = opts.nodes.empty() ? vector<int>{0} : opts.nodes;
+    mt19937 rng(opts.seed + 2);
+    int errors = 0;
+    vector<Dist> dist;
+    vector<int> prev;
+    for (int node : nodes) {
+        if (node < 0 || node >= g.n) {
+            cerr << "Error: Node " << node << " is outside the topology" << endl;
+            return 1;
+        }
+        dijkstra(g, node, dist, prev);
+        vector<Route> routes = buildRoutes(node, owners, dist, prev);
+        if (opts.print) printFib(node, routes);
+
+        auto start = chrono::steady_clock::now();
+        Dir248Fib fib(routes);
+        double buildSeconds = secondsSince(start);
+        ReferenceFib reference(routes);
+        cout << (opts.print ? "" : "\n") << "Node " << node << ": " << routes.size() << " routes, DIR-24-8 built in "
+             << buildSeconds << " s, " << fib.groupCount() << " tbl8 groups, " << fib.memoryBytes() / (1 << 20) << " MiB\n";
+
+        // Check every route's first and last address plus a sample of random ones; the
+        // reference is slow on big tables, so it is not run over all lookups
+        vector<uint32_t> addrs = randomAddresses(routes, max(opts.lookups, 1000000L), rng);
+        vector<uint32_t> check(addrs.begin(), addrs.begin() + 1000000);
+        for (const Route& r : routes) {
+            uint32_t host = r.prefix.len == 0 ? ~uint32_t(0) : (uint32_t(1) << (32 - r.prefix.len)) - 1;
+            check.push_back(r.prefix.addr);
+            check.push_back(r.prefix.addr | host);
+        }
+        vector<int> batch(check.size());
+        fib.lookupBatch(check.data(), batch.data(), check.size());
+        long mismatches = 0;
+        for (size_t i = 0; i < check.size(); ++i) {
+            int expected = reference.lookup(check[i]);
+            if (fib.lookup(check[i]) == expected && batch[i] == expected) continue;
+            if (mismatches++ < 10)
+                cerr << "Mismatch at node " << node << " for " << formatPrefix({check[i], 32}) << ": reference "
+                     << expected << ", DIR-24-8 " << fib.lookup(check[i]) << ", batch " << batch[i] << endl;
+        }
+        cout << "Verified " << check.size() << " lookups against the reference: " << mismatches << " mismatches\n";
+        errors += mismatches > 0;
+
+        if (opts.lookups <= 0) continue;
+        long count = opts.lookups;
+        addrs.resize(count);
+        batch.resize(count);
+        cout << "\n" << left << setw(22) << "Lookup" << right << setw(12) << "Addresses" << setw(12) << "ns/lookup"
+             << setw(12) << "Mlookups/s" << setw(16) << "Checksum" << "\n";
+        long sample = min(count, 1000000L);
+        benchmark("Reference (hash/len)", sample, [&] {
+            long sum = 0;
+            for (long i = 0; i < sample; ++i) sum += reference.lookup(addrs[i]);
+            return sum;
+        });
+        benchmark("DIR-24-8 single", count, [&] {
+            long sum = 0;
+            for (uint32_t a : addrs) sum += fib.lookup(a);
+            return sum;
+        });
+        benchmark("DIR-24-8 batched", count, [&] {
+            fib.lookupBatch(addrs.data(), batch.data(), count);
+            long sum = 0;
+            for (int h : batch) sum += h;
+            return sum;
+        });
+    }
+    return errors ? 1 : 0;
+}
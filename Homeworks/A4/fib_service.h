@@ -0,0 +1,24 @@
+#ifndef FIB_SERVICE_H
+#define FIB_SERVICE_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+
+// FIB mode of routing_sim: compiles the LSR routing tables of selected nodes into
+// longest-prefix-match forwarding tables, checks them against a reference lookup
+// and measures lookup throughput over random destination addresses.
+
+struct FibServiceOptions {
+    std::string prefixFile;         // Prefix-to-node assignment; generated if empty
+    int prefixesPerNode = 4;        // For generated assignments
+    std::vector<int> nodes;         // Routers to compile a FIB for (default: node 0)
+    bool print = false;             // Print the compiled routes
+    long lookups = 10000000;        // Random addresses to time per node, 0 to skip
+    unsigned seed = 1;
+};
+
+// Returns the process exit code: non-zero if a FIB disagreed with the reference
+int runFibService(const Graph& g, const FibServiceOptions& opts);
+
+#endif // FIB_SERVICE_H
@@ -0,0 +1,129 @@
+#include "graph.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+
+using namespace std;
+
+Dist Graph::linkCost(int u, int v) const {
+    auto first = target.begin() + offset[u], last = target.begin() + offset[u + 1];
+    auto it = lower_bound(first, last, v);
+    if (it == last || *it != v) return UNREACHABLE;
+    return weight[it - target.begin()];
+}
+
+Graph buildGraph(int n, vector<Edge> edges) {
+    // Sort by (from, to, weight) so the cheapest of parallel edges comes first
+    edges.erase(remove_if(edges.begin(), edges.end(), [](const Edge& e) { return e.from == e.to; }), edges.end());
+    sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+        if (a.from != b.from) return a.from < b.from;
+        if (a.to != b.to) return a.to < b.to;
+        return a.weight < b.weight;
+    });
+    edges.erase(unique(edges.begin(), edges.end(),
+                       [](const Edge& a, const Edge& b) { return a.from == b.from && a.to == b.to; }),
+                edges.end());
+
+    Graph g;
+    g.n = n;
+    g.offset.assign(n + 1, 0);
+    g.roffset.assign(n + 1, 0);
+    for (const Edge& e : edges) {
+        g.offset[e.from + 1]++;
+        g.roffset[e.to + 1]++;
+    }
+    for (int i = 0; i < n; ++i) {
+        g.offset[i + 1] += g.offset[i];
+        g.roffset[i + 1] += g.roffset[i];
+    }
+
+    g.target.resize(edges.size());
+    g.weight.resize(edges.size());
+    g.source.resize(edges.size());
+    g.rweight.resize(edges.size());
+    vector<int> rpos(g.roffset.begin(), g.roffset.end() - 1);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        // Edges are sorted by source, so out-edges are already in place
+        g.target[i] = edges[i].to;
+        g.weight[i] = edges[i].weight;
+        int r = rpos[edges[i].to]++;
+        g.source[r] = edges[i].from;
+        g.rweight[r] = edges[i].weight;
+    }
+    return g;
+}
+
+Graph graphFromMatrix(const vector<vector<int>>& matrix) {
+    int n = matrix.size();
+    vector<Edge> edges;
+    for (int u = 0; u < n; ++u)
+        for (int v = 0; v < n; ++v)
+            if (u != v && matrix[u][v] != 0 && matrix[u][v] != INF)
+                edges.push_back({u, v, matrix[u][v]});
+    return buildGraph(n, move(edges));
+}
+
+vector<vector<int>> matrixFromGraph(const Graph& g) {
+    vector<vector<int>> matrix(g.n, vector<int>(g.n, INF));
+    for (int u = 0; u < g.n; ++u) {
+        matrix[u][u] = 0;
+        for (int e = g.offset[u]; e < g.offset[u + 1]; ++e)
+            matrix[u][g.target[e]] = g.weight[e];
+    }
+    return matrix;
+}
+
+vector<vector<int>> readGraphFromFile(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        exit(1);
+    }
+
+    int n;
+    file >> n;
+    vector<vector<int>> graph(n, vector<int>(n));
+
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            file >> graph[i][j];
+
+    file.close();
+    return graph;
+}
+
+void dijkstra(const Graph& g, int src, vector<Dist>& dist, vector<int>& prev) {
+    dist.assign(g.n, UNREACHABLE);
+    prev.assign(g.n, -1);
+    dist[src] = 0;
+
+    // Min-heap of {distance, node}; stale entries are skipped when popped
+    priority_queue<pair<Dist, int>, vector<pair<Dist, int>>, greater<pair<Dist, int>>> pq;
+    pq.push({0, src});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u])
+            continue;
+        for (int e = g.offset[u]; e < g.offset[u + 1]; ++e) {
+            int v = g.target[e];
+            Dist newDist = d + g.weight[e];
+            if (newDist < dist[v]) {
+                dist[v] = newDist;
+                prev[v] = u;
+                pq.push({newDist, v});
+            }
+        }
+    }
+}
+
+int nextHopFromPrev(int src, int dest, const vector<int>& prev) {
+    // Walk back from the destination until the node whose predecessor is the source
+    int hop = dest;
+    while (prev[hop] != src && prev[hop] != -1)
+        hop = prev[hop];
+    return prev[hop] == -1 ? -1 : hop;
+}
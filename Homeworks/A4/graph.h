@@ -0,0 +1,52 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cost used in the adjacency-matrix input for "no link" (0 off the diagonal means the same)
+const int INF = 9999;
+
+// Path costs in the graph code; large topologies easily exceed INF
+using Dist = std::int64_t;
+const Dist UNREACHABLE = INT64_MAX / 4;
+
+struct Edge {
+    int from, to, weight;
+};
+
+// Directed graph in compressed sparse row form. Out-edges of u are
+// [offset[u], offset[u + 1]) in target/weight; in-edges of v are
+// [roffset[v], roffset[v + 1]) in source/rweight. Both are sorted by the other endpoint.
+struct Graph {
+    int n = 0;
+    std::vector<int> offset, target, weight;
+    std::vector<int> roffset, source, rweight;
+
+    int edgeCount() const { return static_cast<int>(target.size()); }
+
+    // Cost of the direct link u -> v, or UNREACHABLE if there is none
+    Dist linkCost(int u, int v) const;
+};
+
+// Build a graph from an edge list; self loops are dropped and of parallel edges
+// only the cheapest is kept
+Graph buildGraph(int n, std::vector<Edge> edges);
+
+// Adjacency matrix as read by readGraphFromFile: 0 or INF off the diagonal is no link
+Graph graphFromMatrix(const std::vector<std::vector<int>>& matrix);
+
+// The inverse, for feeding generated topologies to the matrix-based simulations
+std::vector<std::vector<int>> matrixFromGraph(const Graph& g);
+
+std::vector<std::vector<int>> readGraphFromFile(const std::string& filename);
+
+// Single-source Dijkstra (the LSR computation) over the adjacency lists.
+// dist[v] is UNREACHABLE and prev[v] is -1 for nodes that cannot be reached.
+void dijkstra(const Graph& g, int src, std::vector<Dist>& dist, std::vector<int>& prev);
+
+// First hop on the path src -> dest given Dijkstra's predecessor array, -1 if none
+int nextHopFromPrev(int src, int dest, const std::vector<int>& prev);
+
+#endif // GRAPH_H
@@ -0,0 +1,145 @@
+#include "path_service.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include "ch.h"
+
+using namespace std;
+
+namespace {
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void printPath(int src, int dest, const PathResult& r) {
+    cout << "Path " << src << " -> " << dest << ": ";
+    if (r.cost == UNREACHABLE) {
+        cout << "unreachable\n";
+        return;
+    }
+    cout << "cost " << r.cost << ", " << r.path.size() - 1 << " hops: ";
+    for (size_t i = 0; i < r.path.size(); ++i) cout << (i ? " " : "") << r.path[i];
+    cout << "\n";
+}
+
+// A path is valid if it runs src -> dest over existing links and costs what was claimed
+bool validPath(const Graph& g, int src, int dest, const PathResult& r) {
+    if (r.path.empty() || r.path.front() != src || r.path.back() != dest) return false;
+    Dist total = 0;
+    for (size_t i = 0; i + 1 < r.path.size(); ++i) {
+        Dist link = g.linkCost(r.path[i], r.path[i + 1]);
+        if (link == UNREACHABLE) return false;
+        total += link;
+    }
+    return total == r.cost;
+}
+
+// Time `count` queries through `run`, which returns the work done (settled nodes)
+template <typename Run>
+void benchmark(const string& name, long count, Run run) {
+    long settled = 0;
+    auto start = chrono::steady_clock::now();
+    for (long i = 0; i < count; ++i) settled += run(i);
+    double seconds = secondsSince(start);
+    cout << left << setw(26) << name << right << setw(9) << count << setw(14) << fixed << setprecision(2)
+         << seconds * 1e6 / count << setw(14) << setprecision(0) << count / seconds << setw(14)
+         << static_cast<double>(settled) / count << "\n";
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+} // namespace
+
+int runPathService(const Graph& g, const PathServiceOptions& opts) {
+    cout << "Topology: " << g.n << " nodes, " << g.edgeCount() << " links\n";
+
+    unique_ptr<ContractionHierarchy> ch;
+    unique_ptr<ChQuery> chQuery;
+    if (opts.useCH) {
+        ch = make_unique<ContractionHierarchy>(g);
+        chQuery = make_unique<ChQuery>(*ch);
+        cout << "Contraction hierarchy built in " << ch->buildSeconds() << " s, " << ch->shortcutCount()
+             << " shortcuts\n";
+    }
+    BidirectionalDijkstra bidi(g);
+    auto query = [&](int src, int dest, bool withPath) {
+        return chQuery ? chQuery->query(src, dest, withPath) : bidi.query(src, dest, withPath);
+    };
+
+    for (auto [src, dest] : opts.queries) {
+        if (src < 0 || dest < 0 || src >= g.n || dest >= g.n) {
+            cerr << "Error: Query " << src << " -> " << dest << " is outside the topology" << endl;
+            return 1;
+        }
+        printPath(src, dest, query(src, dest, true));
+    }
+
+    int errors = 0;
+    if (opts.verifySources > 0 && g.n > 0) {
+        // Every answer must match LSR's cost and be a real path of that cost. The first
+        // hop may differ from LSR's next hop only when there are equal-cost paths.
+        mt19937 rng(opts.seed + 1);
+        uniform_int_distribution<int> node(0, g.n - 1);
+        vector<Dist> dist;
+        vector<int> prev;
+        long checked = 0, hopTies = 0;
+        for (int s = 0; s < opts.verifySources; ++s) {
+            int src = node(rng);
+            dijkstra(g, src, dist, prev);
+            vector<int> targets;
+            if (g.n <= 2000) {
+                for (int t = 0; t < g.n; ++t) targets.push_back(t);
+            } else {
+                for (int t = 0; t < 200; ++t) targets.push_back(node(rng));
+            }
+            for (int dest : targets) {
+                PathResult fast = query(src, dest, true);
+                PathResult plain = bidi.query(src, dest, true);
+                checked++;
+                bool ok = fast.cost == dist[dest] && plain.cost == dist[dest] &&
+                          (dist[dest] == UNREACHABLE || (validPath(g, src, dest, fast) && validPath(g, src, dest, plain)));
+                if (!ok) {
+                    if (errors++ < 10)
+                        cerr << "Mismatch " << src << " -> " << dest << ": LSR " << dist[dest] << ", query " << fast.cost
+                             << ", bidirectional " << plain.cost << endl;
+                    continue;
+                }
+                if (src != dest && dist[dest] != UNREACHABLE && fast.path[1] != nextHopFromPrev(src, dest, prev))
+                    hopTies++;
+            }
+        }
+        cout << "Verified " << checked << " pairs from " << opts.verifySources << " sources against LSR: " << errors
+             << " mismatches, " << hopTies << " equal-cost next-hop ties\n";
+    }
+
+    if (opts.benchQueries > 0 && g.n > 0) {
+        mt19937 rng(opts.seed);
+        uniform_int_distribution<int> node(0, g.n - 1);
+        vector<pair<int, int>> pairs(opts.benchQueries);
+        for (auto& p : pairs) p = {node(rng), node(rng)};
+
+        cout << "\n" << left << setw(26) << "Method" << right << setw(9) << "Queries" << setw(14) << "us/query"
+             << setw(14) << "queries/s" << setw(14) << "settled/q" << "\n";
+        if (ch) {
+            benchmark("CH cost only", pairs.size(),
+                      [&](long i) { return chQuery->query(pairs[i].first, pairs[i].second, false).settled; });
+            benchmark("CH cost + path", pairs.size(),
+                      [&](long i) { return chQuery->query(pairs[i].first, pairs[i].second, true).settled; });
+        }
+        // The uninformed searches are much slower; a sample is enough
+        long sample = min<long>(pairs.size(), ch ? 1000 : pairs.size());
+        benchmark("Bidirectional Dijkstra", sample,
+                  [&](long i) { return bidi.query(pairs[i].first, pairs[i].second, true).settled; });
+        vector<Dist> dist;
+        vector<int> prev;
+        benchmark("LSR Dijkstra (one source)", min<long>(pairs.size(), 20), [&](long i) {
+            dijkstra(g, pairs[i].first, dist, prev);
+            return g.n;
+        });
+    }
+    return errors ? 1 : 0;
+}
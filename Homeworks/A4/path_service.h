@@ -0,0 +1,23 @@
+#ifndef PATH_SERVICE_H
+#define PATH_SERVICE_H
+
+#include <utility>
+#include <vector>
+#include "graph.h"
+
+// Point-to-point path mode of routing_sim: answers "best path from A to B" with a
+// contraction hierarchy (or plain bidirectional Dijkstra), benchmarks random
+// queries and checks the answers against LSR's full Dijkstra tables.
+
+struct PathServiceOptions {
+    std::vector<std::pair<int, int>> queries;  // Paths to print
+    long benchQueries = 100000;                // Random pairs to time, 0 to skip
+    int verifySources = 20;                    // LSR sources to check against, 0 to skip
+    bool useCH = true;                         // false: bidirectional Dijkstra only
+    unsigned seed = 1;
+};
+
+// Returns the process exit code: non-zero if verification found a wrong answer
+int runPathService(const Graph& g, const PathServiceOptions& opts);
+
+#endif // PATH_SERVICE_H
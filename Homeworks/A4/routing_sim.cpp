@@ -5,44 +5,47 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include "async_dvr.h"
+#include "ecmp.h"
+#include "ecmp_service.h"
+#include "fib_service.h"
+#include "graph.h"
+#include "path_service.h"
+#include "topology.h"
 
 using namespace std;
 
-const int INF = 9999;
+// Next hops as a comma-separated list; `none` if there are none
+void printNextHops(const NextHopSet& hops, const char* none) {
+    if (hops.empty()) cout << none;
+    for (int i = 0; i < hops.size(); ++i) cout << (i ? "," : "") << hops[i];
+}
 
-void printDVRTable(int node, const vector<vector<int>>& table, const vector<vector<int>>& nextHop) {
+void printDVRTable(int node, const vector<vector<int>>& table, const vector<vector<NextHopSet>>& nextHop) {
     cout << "Node " << node << " Routing Table:\n";
     cout << "Dest\tCost\tNext Hop\n";
     for (int i = 0; i < table.size(); ++i) {
         cout << i << "\t" << table[node][i] << "\t";
-        if (nextHop[node][i] == -1) cout << "-";
-        else cout << nextHop[node][i];
+        printNextHops(nextHop[node][i], "-");
         cout << endl;
     }
     cout << endl;
 }
 
-void simulateDVR(const vector<vector<int>>& graph) {
+// With ecmp, every next hop of an equal-cost route is kept, not just the first found
+void simulateDVR(const vector<vector<int>>& graph, bool ecmp) {
     int n = graph.size();
     vector<vector<int>> dist = graph;
-    vector<vector<int>> nextHop(n, vector<int>(n));
+    vector<vector<NextHopSet>> nextHop(n, vector<NextHopSet>(n));
     
     // Initialize the nextHop matrix
     for (int i = 0; i < n; ++i) {
         for (int j = 0; j < n; ++j) {
 
-            // If j is same node as i
-            if (i == j) {
-                // No next hop to itself
-                nextHop[i][j] = -1;  
-            }
-            // If there is a reachable link from i to j 
-            else if (graph[i][j] != INF && graph[i][j] != 0) { 
-                nextHop[i][j] = j;   
-            } 
-            // If there is no reachable link from i to j
-            else {
-                nextHop[i][j] = -1;  // No direct link
+            // If there is a reachable link from i to j, j is the next hop.
+            // No next hop to itself or without a direct link: the set stays empty.
+            if (i != j && graph[i][j] != INF && graph[i][j] != 0) {
+                nextHop[i][j].insert(j);
             }
         }
     }
@@ -86,6 +89,10 @@ void simulateDVR(const vector<vector<int>>& graph) {
                         nextHop[i][j] = nextHop[i][k];  
                         updated = true;
                     }
+                    // An equal-cost route through k adds k's next hops
+                    else if (ecmp && newDist == dist[i][j] && nextHop[i][j].merge(nextHop[i][k])) {
+                        updated = true;
+                    }
                 }
             }
         }
@@ -103,102 +110,247 @@ void simulateDVR(const vector<vector<int>>& graph) {
     for (int i = 0; i < n; ++i) printDVRTable(i, dist, nextHop);
 }
 
-void printLSRTable(int src, const vector<int>& dist, const vector<int>& prev) {
+void printLSRTable(int src, const vector<Dist>& dist, const vector<NextHopSet>& hops) {
     cout << "Node " << src << " Routing Table:\n";
     cout << "Dest\tCost\tNext Hop\n";
     for (int i = 0; i < dist.size(); ++i) {
         if (i == src) continue;
-        cout << i << "\t" << dist[i] << "\t";
-        int hop = i;
-        while (prev[hop] != src && prev[hop] != -1)
-            hop = prev[hop];
-        cout << (prev[hop] == -1 ? -1 : hop) << endl;
+        cout << i << "\t" << (dist[i] == UNREACHABLE ? INF : dist[i]) << "\t";
+        printNextHops(hops[i], "-1");
+        cout << endl;
     }
     cout << endl;
 }
 
-void simulateLSR(const vector<vector<int>>& graph) {
-    int n = graph.size();
-    for (int src = 0; src < n; ++src) {
-        vector<int> dist(n, INF);
-        vector<int> prev(n, -1);
-        vector<bool> visited(n, false);
-        dist[src] = 0;
-        
-        // Optimized Dijkstra's algorithm using a priority queue
-
-        // Create a min-heap via priority queue to store {distance, node}
-        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
-
-        // Push the {distance = 0, source node} into the priority queue
-        pq.push({0, src});
-        // Set distance of source node to 0
-        dist[src] = 0;
-
-        // While the priority queue is not empty, i.e. processable nodes exist
-        while (!pq.empty()) {
-
-            // Get the node with the smallest distance from top of min-heap
-            int u = pq.top().second;
-            // Remove the corresponding element from the priority queue
-            pq.pop();
-
-            // If the node has already been visited, skip it
-            if (visited[u]) 
-                continue;
-            // Else mark it as visited
-            visited[u] = true;
-
-            // For each neighbor of the current node
-            for (int v = 0; v < n; ++v) {
-                // Skip if same node
-                if (u == v) 
-                    continue;  
-                
-                // If there is a link from u to v which is reachable(not infinite) 
-                // and v is not visited yet
-                if (graph[u][v] != 0 && graph[u][v] != INF && !visited[v]) {
-
-                    // Calculate distance to v through u
-                    int newDist = dist[u] + graph[u][v];
-                    // If the new distance is less than the current known distance to v
-                    if (newDist < dist[v]) {
-                        // Update the distance and previous node
-                        // And add the {newDistance, v} pair to the priority queue to process
-                        dist[v] = newDist;
-                        prev[v] = u;
-                        pq.push({newDist, v});
-                    }
-                }
+void simulateLSR(const vector<vector<int>>& graph, bool ecmp) {
+    // Dijkstra from every node over the adjacency lists of the link matrix
+    Graph g = graphFromMatrix(graph);
+    vector<Dist> dist;
+    vector<NextHopSet> hops;
+    for (int src = 0; src < g.n; ++src) {
+        dijkstraNextHops(g, src, dist, hops, ecmp);
+        printLSRTable(src, dist, hops);
+    }
+}
+
+void printUsage(const char* prog) {
+    cerr << "Usage: " << prog << " <input_file>\n"
+         << "       " << prog << " --paths [options] (<input_file> | --gen SPEC)\n"
+         << "       " << prog << " --ecmp [options] (<input_file> | --gen SPEC)\n"
+         << "       " << prog << " --fib [options] (<input_file> | --gen SPEC)\n"
+         << "       " << prog << " --async-dvr [options] (<input_file> | --gen SPEC)\n"
+         << "\n"
+         << "Point-to-point path mode options:\n"
+         << "  --query S:T      print the best path from S to T (repeatable)\n"
+         << "  --bench N        time N random queries (default 100000, 0 to skip)\n"
+         << "  --verify N       check queries from N random sources against LSR (default 20)\n"
+         << "  --no-ch          bidirectional Dijkstra only, no preprocessing\n"
+         << "  --seed X         seed for generated topologies and random queries\n"
+         << "  --gen SPEC       generated topology: grid:R:C[:MAX], torus:R:C[:MAX], geo:N:K\n"
+         << "                   or fattree:K\n"
+         << "\n"
+         << "ECMP mode (" << prog << " --ecmp [options] (<input_file> | --gen SPEC)):\n"
+         << "  prints the DVR and LSR tables with every equal-cost next hop, or with\n"
+         << "  --flows N        routes N random flows by 5-tuple hash and reports link loads\n"
+         << "  --endpoints N    flows run between nodes 0..N-1 (default all nodes)\n"
+         << "  --seed X         seed for generated topologies and flows\n"
+         << "\n"
+         << "Asynchronous DVR mode options (" << prog << " --async-dvr [options] (<input_file> | --gen SPEC)):\n"
+         << "  --threads N      worker threads (default one per core)\n"
+         << "  --dests N        route to N random destinations (default all up to 2000 nodes, else 64)\n"
+         << "  --us-per-cost X  link latency in microseconds per unit of link cost (default 1)\n"
+         << "  --verify N       check N destinations against Dijkstra (default 8)\n"
+         << "  --seed X         seed for generated topologies and destinations\n"
+         << "\n"
+         << "FIB mode options (" << prog << " --fib [options] (<input_file> | --gen SPEC)):\n"
+         << "  --prefixes FILE  prefix assignment, one \"a.b.c.d/len node\" per line\n"
+         << "  --gen-prefixes K generate K prefixes per node instead (default 4)\n"
+         << "  --node X         compile and benchmark the FIB of node X (repeatable, default 0)\n"
+         << "  --print          print the compiled routes\n"
+         << "  --lookups N      time N random address lookups (default 10000000, 0 to skip)\n"
+         << "  --seed X         seed for generated topologies, prefixes and addresses\n";
+}
+
+int runPathMode(int argc, char* argv[]) {
+    PathServiceOptions opts;
+    string filename, spec;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--query" && hasValue) {
+            int src, dest;
+            char sep;
+            stringstream ss(argv[++i]);
+            if (!(ss >> src >> sep >> dest) || sep != ':') {
+                printUsage(argv[0]);
+                return 1;
             }
+            opts.queries.push_back({src, dest});
+        } else if (arg == "--bench" && hasValue) {
+            opts.benchQueries = atol(argv[++i]);
+        } else if (arg == "--verify" && hasValue) {
+            opts.verifySources = atoi(argv[++i]);
+        } else if (arg == "--no-ch") {
+            opts.useCH = false;
+        } else if (arg == "--seed" && hasValue) {
+            opts.seed = atoi(argv[++i]);
+        } else if (arg == "--gen" && hasValue) {
+            spec = argv[++i];
+        } else if (arg[0] != '-' && filename.empty()) {
+            filename = arg;
+        } else {
+            printUsage(argv[0]);
+            return 1;
         }
-        
-        printLSRTable(src, dist, prev);
     }
+    if (filename.empty() == spec.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Graph g = spec.empty() ? graphFromMatrix(readGraphFromFile(filename)) : generateTopology(spec, opts.seed);
+    return runPathService(g, opts);
 }
 
-vector<vector<int>> readGraphFromFile(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Error: Could not open file " << filename << endl;
-        exit(1);
+int runFibMode(int argc, char* argv[]) {
+    FibServiceOptions opts;
+    string filename, spec;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--prefixes" && hasValue) {
+            opts.prefixFile = argv[++i];
+        } else if (arg == "--gen-prefixes" && hasValue) {
+            opts.prefixesPerNode = atoi(argv[++i]);
+        } else if (arg == "--node" && hasValue) {
+            opts.nodes.push_back(atoi(argv[++i]));
+        } else if (arg == "--print") {
+            opts.print = true;
+        } else if (arg == "--lookups" && hasValue) {
+            opts.lookups = atol(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            opts.seed = atoi(argv[++i]);
+        } else if (arg == "--gen" && hasValue) {
+            spec = argv[++i];
+        } else if (arg[0] != '-' && filename.empty()) {
+            filename = arg;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (filename.empty() == spec.empty()) {
+        printUsage(argv[0]);
+        return 1;
     }
-    
-    int n;
-    file >> n;
-    vector<vector<int>> graph(n, vector<int>(n));
 
-    for (int i = 0; i < n; ++i)
-        for (int j = 0; j < n; ++j)
-            file >> graph[i][j];
+    Graph g = spec.empty() ? graphFromMatrix(readGraphFromFile(filename)) : generateTopology(spec, opts.seed);
+    return runFibService(g, opts);
+}
 
-    file.close();
-    return graph;
+int runEcmpMode(int argc, char* argv[]) {
+    EcmpServiceOptions opts;
+    opts.flows = 0;
+    string filename, spec;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--flows" && hasValue) {
+            opts.flows = atol(argv[++i]);
+        } else if (arg == "--endpoints" && hasValue) {
+            opts.endpoints = atoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            opts.seed = atoi(argv[++i]);
+        } else if (arg == "--gen" && hasValue) {
+            spec = argv[++i];
+        } else if (arg[0] != '-' && filename.empty()) {
+            filename = arg;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (filename.empty() == spec.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<vector<int>> graph;
+    if (!filename.empty()) {
+        graph = readGraphFromFile(filename);
+    }
+    if (opts.flows > 0) {
+        runEcmpService(spec.empty() ? graphFromMatrix(graph) : generateTopology(spec, opts.seed), opts);
+        return 0;
+    }
+    if (graph.empty()) {
+        // Tables of a generated topology: the simulations work on the link matrix
+        Graph g = generateTopology(spec, opts.seed);
+        if (g.n > 1000) {
+            cerr << "Error: " << g.n << " nodes is too many to print tables for; use --flows" << endl;
+            return 1;
+        }
+        graph = matrixFromGraph(g);
+    }
+
+    cout << "\n--- Distance Vector Routing Simulation (ECMP) ---\n";
+    simulateDVR(graph, true);
+
+    cout << "\n--- Link State Routing Simulation (ECMP) ---\n";
+    simulateLSR(graph, true);
+
+    return 0;
+}
+
+int runAsyncDvrMode(int argc, char* argv[]) {
+    AsyncDvrOptions opts;
+    string filename, spec;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            opts.threads = atoi(argv[++i]);
+        } else if (arg == "--dests" && hasValue) {
+            opts.destinations = atoi(argv[++i]);
+        } else if (arg == "--us-per-cost" && hasValue) {
+            opts.usPerCost = atof(argv[++i]);
+        } else if (arg == "--verify" && hasValue) {
+            opts.verifyDestinations = atoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            opts.seed = atoi(argv[++i]);
+        } else if (arg == "--gen" && hasValue) {
+            spec = argv[++i];
+        } else if (arg[0] != '-' && filename.empty()) {
+            filename = arg;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (filename.empty() == spec.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Graph g = spec.empty() ? graphFromMatrix(readGraphFromFile(filename)) : generateTopology(spec, opts.seed);
+    return runAsyncDvr(g, opts);
 }
 
 int main(int argc, char *argv[]) {
+    if (argc > 1 && string(argv[1]) == "--paths") {
+        return runPathMode(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--ecmp") {
+        return runEcmpMode(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--async-dvr") {
+        return runAsyncDvrMode(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--fib") {
+        return runFibMode(argc, argv);
+    }
     if (argc != 2) {
-        cerr << "Usage: " << argv[0] << " <input_file>\n";
+        printUsage(argv[0]);
         return 1;
     }
 
@@ -206,10 +358,10 @@ int main(int argc, char *argv[]) {
     vector<vector<int>> graph = readGraphFromFile(filename);
 
     cout << "\n--- Distance Vector Routing Simulation ---\n";
-    simulateDVR(graph);
+    simulateDVR(graph, false);
 
     cout << "\n--- Link State Routing Simulation ---\n";
-    simulateLSR(graph);
+    simulateLSR(graph, false);
 
     return 0;
 }
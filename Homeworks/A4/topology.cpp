@@ -0,0 +1,115 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+vector<long> parseParams(const string& spec, string& kind) {
+    stringstream ss(spec);
+    getline(ss, kind, ':');
+    vector<long> params;
+    string item;
+    while (getline(ss, item, ':'))
+        params.push_back(atol(item.c_str()));
+    return params;
+}
+
+void addLink(vector<Edge>& edges, int u, int v, int cost) {
+    edges.push_back({u, v, cost});
+    edges.push_back({v, u, cost});
+}
+
+Graph gridTopology(int rows, int cols, bool wrap, int maxCost, mt19937& rng) {
+    uniform_int_distribution<int> cost(1, maxCost);
+    vector<Edge> edges;
+    auto id = [cols](int r, int c) { return r * cols + c; };
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (c + 1 < cols || (wrap && cols > 2)) addLink(edges, id(r, c), id(r, (c + 1) % cols), cost(rng));
+            if (r + 1 < rows || (wrap && rows > 2)) addLink(edges, id(r, c), id((r + 1) % rows, c), cost(rng));
+        }
+    }
+    return buildGraph(rows * cols, move(edges));
+}
+
+Graph geometricTopology(int n, int k, mt19937& rng) {
+    uniform_real_distribution<double> coord(0, 1);
+    vector<double> x(n), y(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = coord(rng);
+        y[i] = coord(rng);
+    }
+
+    // Bucket the points so each cell holds about k of them; the k nearest
+    // neighbours are then almost always within the surrounding 3 x 3 cells
+    int side = max(1, static_cast<int>(sqrt(static_cast<double>(n) / k)));
+    vector<vector<int>> cells(side * side);
+    auto cellOf = [side](double v) { return min(side - 1, static_cast<int>(v * side)); };
+    for (int i = 0; i < n; ++i)
+        cells[cellOf(y[i]) * side + cellOf(x[i])].push_back(i);
+
+    vector<Edge> edges;
+    vector<pair<double, int>> candidates;
+    for (int i = 0; i < n; ++i) {
+        candidates.clear();
+        int cx = cellOf(x[i]), cy = cellOf(y[i]);
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = cx + dx, ny = cy + dy;
+                if (nx < 0 || ny < 0 || nx >= side || ny >= side) continue;
+                for (int j : cells[ny * side + nx])
+                    if (j != i) candidates.push_back({hypot(x[i] - x[j], y[i] - y[j]), j});
+            }
+        }
+        int take = min<int>(k, candidates.size());
+        partial_sort(candidates.begin(), candidates.begin() + take, candidates.end());
+        // Scale so a typical link costs about 100
+        for (int c = 0; c < take; ++c)
+            addLink(edges, i, candidates[c].second, 1 + static_cast<int>(candidates[c].first * sqrt(n) * 100));
+    }
+    return buildGraph(n, move(edges));
+}
+
+// k-ary fat-tree (Al-Fares et al.): k pods of k/2 edge and k/2 aggregation switches,
+// fully connected inside the pod, and (k/2)^2 core switches. Aggregation switch a of
+// every pod links to cores a*(k/2) .. a*(k/2)+k/2-1. All links cost 1, so every pair
+// of edge switches in different pods has (k/2)^2 equal-cost paths.
+Graph fatTreeTopology(int k) {
+    int half = k / 2;
+    int edgeBase = 0, aggBase = k * half, coreBase = 2 * k * half;
+    vector<Edge> edges;
+    for (int pod = 0; pod < k; ++pod) {
+        for (int a = 0; a < half; ++a) {
+            int agg = aggBase + pod * half + a;
+            for (int e = 0; e < half; ++e) addLink(edges, edgeBase + pod * half + e, agg, 1);
+            for (int c = 0; c < half; ++c) addLink(edges, agg, coreBase + a * half + c, 1);
+        }
+    }
+    return buildGraph(coreBase + half * half, move(edges));
+}
+
+} // namespace
+
+Graph generateTopology(const string& spec, unsigned seed) {
+    mt19937 rng(seed);
+    string kind;
+    vector<long> p = parseParams(spec, kind);
+
+    if ((kind == "grid" || kind == "torus") && (p.size() == 2 || p.size() == 3) && p[0] > 0 && p[1] > 0 &&
+        (p.size() == 2 || p[2] > 0))
+        return gridTopology(p[0], p[1], kind == "torus", p.size() == 3 ? p[2] : 100, rng);
+    if (kind == "geo" && p.size() == 2 && p[0] > 1 && p[1] > 0)
+        return geometricTopology(p[0], p[1], rng);
+    if (kind == "fattree" && p.size() == 1 && p[0] >= 2 && p[0] % 2 == 0)
+        return fatTreeTopology(p[0]);
+
+    cerr << "Error: Unknown topology " << spec << " (expected grid:R:C[:MAX], torus:R:C[:MAX], geo:N:K or fattree:K)"
+         << endl;
+    exit(1);
+}
@@ -0,0 +1,21 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include "graph.h"
+
+// Synthetic topologies for runs that are too large for an adjacency-matrix file.
+// All links are bidirectional with the same cost both ways.
+//
+//   grid:R:C[:MAX]   R x C mesh, random link costs 1..MAX (default 100; 1 gives the
+//                    uniform costs of a datacenter fabric)
+//   torus:R:C[:MAX]  grid with wrap-around links
+//   geo:N:K          N routers at random points in the unit square, each linked to its
+//                    K nearest neighbours, cost proportional to distance (road-network like)
+//   fattree:K        K-ary fat-tree (K even), all links cost 1. Nodes are numbered edge
+//                    switches first (K*K/2 of them), then aggregation, then core.
+//
+// Costs and placement come from `seed`, so the same spec always gives the same graph.
+Graph generateTopology(const std::string& spec, unsigned seed);
+
+#endif // TOPOLOGY_H
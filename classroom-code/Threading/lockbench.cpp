@@ -0,0 +1,259 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include "locks.h"
+
+// Lock benchmark: like mutexexample.cpp, N threads repeatedly enter a critical section
+// guarded by one lock, but with configurable thread counts, critical-section length and
+// read/write mix. For each lock it reports throughput, fairness (spread of per-thread
+// operation counts) and the tail latency of acquiring the lock, as CSV.
+
+const std::vector<std::string> KNOWN_LOCKS = {"mutex", "shared_mutex", "ttas", "ticket", "mcs", "futex"};
+
+struct BenchConfig {
+    std::vector<std::string> locks = KNOWN_LOCKS;
+    std::vector<long> threads = {1, 2, 4, 8};
+    long cs_len = 100;        // Shared counter updates inside the critical section
+    long outside_len = 100;   // Private work between critical sections
+    int read_pct = 0;         // Percentage of operations that only read the shared data
+    double duration = 1.0;    // Seconds per run
+    int sample_every = 8;     // Time one acquisition in this many
+    std::string output;
+};
+
+// Data protected by the lock, as a group table would be: reads scan it, writes update it
+constexpr int SHARED_SLOTS = 64;
+struct alignas(64) SharedData {
+    long slots[SHARED_SLOTS] = {0};
+    long writes = 0;
+};
+
+struct ThreadResult {
+    long ops = 0;
+    long writes = 0;
+    std::vector<std::uint64_t> acquire_ns;
+};
+
+inline std::uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Read-side locking: shared for std::shared_mutex, exclusive for everything else
+template <typename Lock>
+void lock_read(Lock &l) { l.lock(); }
+template <typename Lock>
+void unlock_read(Lock &l) { l.unlock(); }
+template <>
+void lock_read(std::shared_mutex &l) { l.lock_shared(); }
+template <>
+void unlock_read(std::shared_mutex &l) { l.unlock_shared(); }
+
+template <typename Lock>
+void worker(const BenchConfig &cfg, Lock &lock, SharedData &data, std::atomic<bool> &start,
+            std::atomic<bool> &stop, ThreadResult &result, unsigned seed) {
+    std::minstd_rand rng(seed);
+    volatile long sink = 0;
+    result.acquire_ns.reserve(1 << 16);
+
+    while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        bool is_read = static_cast<int>(rng() % 100) < cfg.read_pct;
+        bool sample = result.ops % cfg.sample_every == 0;
+        std::uint64_t t0 = sample ? now_ns() : 0;
+
+        if (is_read) {
+            lock_read(lock);
+            if (sample) result.acquire_ns.push_back(now_ns() - t0);
+            long sum = 0;
+            for (long i = 0; i < cfg.cs_len; ++i) sum += data.slots[i % SHARED_SLOTS];
+            sink = sum;
+            unlock_read(lock);
+        } else {
+            lock.lock();
+            if (sample) result.acquire_ns.push_back(now_ns() - t0);
+            for (long i = 0; i < cfg.cs_len; ++i) data.slots[i % SHARED_SLOTS]++;
+            data.writes++;
+            lock.unlock();
+            result.writes++;
+        }
+        result.ops++;
+
+        // Work outside the lock
+        for (long i = 0; i < cfg.outside_len; ++i) sink = sink + i;
+    }
+}
+
+template <typename Lock>
+std::string run_lock(const BenchConfig &cfg, const std::string &name, int nthreads) {
+    Lock lock;
+    SharedData data;
+    std::atomic<bool> start{false}, stop{false};
+    std::vector<ThreadResult> results(nthreads);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < nthreads; ++t)
+        threads.emplace_back(worker<Lock>, std::cref(cfg), std::ref(lock), std::ref(data), std::ref(start),
+                             std::ref(stop), std::ref(results[t]), 1234u + t);
+
+    std::uint64_t begin = now_ns();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(cfg.duration));
+    stop.store(true);
+    for (auto &t : threads) t.join();
+    double seconds = (now_ns() - begin) / 1e9;
+
+    // Fairness: coefficient of variation of per-thread op counts (0 = perfectly even)
+    long total = 0, writes = 0, min_ops = results[0].ops, max_ops = results[0].ops;
+    std::vector<std::uint64_t> samples;
+    for (auto &r : results) {
+        total += r.ops;
+        writes += r.writes;
+        min_ops = std::min(min_ops, r.ops);
+        max_ops = std::max(max_ops, r.ops);
+        samples.insert(samples.end(), r.acquire_ns.begin(), r.acquire_ns.end());
+    }
+    double mean = static_cast<double>(total) / nthreads, var = 0;
+    for (auto &r : results) var += (r.ops - mean) * (r.ops - mean);
+    double cv = mean > 0 ? std::sqrt(var / nthreads) / mean : 0;
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) -> std::uint64_t {
+        return samples.empty() ? 0 : samples[static_cast<size_t>(p * (samples.size() - 1))];
+    };
+
+    // A broken lock shows up as lost updates
+    if (data.writes != writes) {
+        std::cerr << name << ": lost updates (" << data.writes << " != " << writes << ")\n";
+    }
+
+    std::ostringstream row;
+    row << name << ',' << nthreads << ',' << cfg.cs_len << ',' << cfg.outside_len << ',' << cfg.read_pct << ','
+        << total << ',' << total / seconds / 1e6 << ',' << cv << ',' << min_ops << ',' << max_ops << ','
+        << pct(0.5) << ',' << pct(0.99) << ',' << pct(0.999) << ',' << (samples.empty() ? 0 : samples.back());
+    return row.str();
+}
+
+// Names are checked against KNOWN_LOCKS before anything runs
+std::string run_case(const BenchConfig &cfg, const std::string &name, int nthreads) {
+    if (name == "mutex") return run_lock<std::mutex>(cfg, name, nthreads);
+    if (name == "shared_mutex") return run_lock<std::shared_mutex>(cfg, name, nthreads);
+    if (name == "ttas") return run_lock<TTASSpinLock>(cfg, name, nthreads);
+    if (name == "ticket") return run_lock<TicketLock>(cfg, name, nthreads);
+    if (name == "mcs") return run_lock<MCSLock>(cfg, name, nthreads);
+    return run_lock<FutexLock>(cfg, name, nthreads);
+}
+
+std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> items;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) items.push_back(item);
+    return items;
+}
+
+// A thread count: a whole number from 1 up, nothing else in the string
+bool parse_thread_count(const std::string &s, long &count) {
+    errno = 0;
+    char *end = nullptr;
+    count = strtol(s.c_str(), &end, 10);
+    return errno == 0 && end != s.c_str() && *end == '\0' && count > 0 &&
+           count <= std::numeric_limits<int>::max();
+}
+
+void usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --locks LIST     mutex,shared_mutex,ttas,ticket,mcs,futex\n"
+              << "  --threads LIST   thread counts (default 1,2,4,8)\n"
+              << "  --cs N           shared updates per critical section (default 100)\n"
+              << "  --outside N      work iterations between critical sections (default 100)\n"
+              << "  --read-pct P     percentage of read-only operations (default 0)\n"
+              << "  --duration SEC   seconds per run (default 1)\n"
+              << "  --output FILE    write CSV to FILE instead of stdout\n";
+}
+
+int main(int argc, char *argv[]) {
+    BenchConfig cfg;
+    static const option long_options[] = {
+        {"locks", required_argument, nullptr, 'l'},
+        {"threads", required_argument, nullptr, 't'},
+        {"cs", required_argument, nullptr, 'c'},
+        {"outside", required_argument, nullptr, 'o'},
+        {"read-pct", required_argument, nullptr, 'r'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"output", required_argument, nullptr, 'f'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 'l': cfg.locks = split(optarg); break;
+        case 't':
+            cfg.threads.clear();
+            for (auto &t : split(optarg)) {
+                long count;
+                if (!parse_thread_count(t, count)) {
+                    std::cerr << "Invalid thread count " << t << "\n";
+                    usage(argv[0]);
+                    return 1;
+                }
+                cfg.threads.push_back(count);
+            }
+            if (cfg.threads.empty()) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'c': cfg.cs_len = atol(optarg); break;
+        case 'o': cfg.outside_len = atol(optarg); break;
+        case 'r': cfg.read_pct = atoi(optarg); break;
+        case 'd': cfg.duration = atof(optarg); break;
+        case 'f': cfg.output = optarg; break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    for (const std::string &name : cfg.locks) {
+        if (std::find(KNOWN_LOCKS.begin(), KNOWN_LOCKS.end(), name) == KNOWN_LOCKS.end()) {
+            std::cerr << "Unknown lock " << name << "\n";
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!cfg.output.empty()) {
+        file.open(cfg.output);
+        if (!file) {
+            perror(("Could not open " + cfg.output).c_str());
+            return 1;
+        }
+    }
+    std::ostream &out = cfg.output.empty() ? std::cout : file;
+
+    out << "lock,threads,cs_len,outside_len,read_pct,ops,mops_per_sec,fairness_cv,min_thread_ops,"
+           "max_thread_ops,acquire_p50_ns,acquire_p99_ns,acquire_p999_ns,acquire_max_ns\n";
+    for (long nthreads : cfg.threads)
+        for (const std::string &name : cfg.locks)
+            out << run_case(cfg, name, static_cast<int>(nthreads)) << std::endl;
+    return 0;
+}
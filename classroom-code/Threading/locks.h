@@ -0,0 +1,145 @@
+#ifndef LOCKS_H
+#define LOCKS_H
+
+// Lock primitives compared by lockbench. All of them offer lock()/unlock(), so they
+// work with std::lock_guard like std::mutex does.
+
+#include <atomic>
+#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spin-wait helper: pause while spinning, and give the CPU away now and then so a
+// preempted lock holder can run when there are more threads than cores
+struct SpinWait {
+    unsigned spins = 0;
+    void wait() {
+        if (++spins % 1024 == 0) std::this_thread::yield();
+        else cpu_relax();
+    }
+};
+
+// Test-and-test-and-set spinlock: spin on a plain load, only attempt the exchange
+// when the lock looks free, so waiters do not keep stealing the cache line
+class TTASSpinLock {
+public:
+    void lock() {
+        SpinWait sw;
+        while (true) {
+            if (!locked_.exchange(true, std::memory_order_acquire)) return;
+            while (locked_.load(std::memory_order_relaxed)) sw.wait();
+        }
+    }
+    void unlock() { locked_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+// Ticket lock: FIFO order, each thread waits for its ticket number to be served
+class TicketLock {
+public:
+    void lock() {
+        unsigned ticket = next_.fetch_add(1, std::memory_order_relaxed);
+        SpinWait sw;
+        while (serving_.load(std::memory_order_acquire) != ticket) sw.wait();
+    }
+    void unlock() { serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+    alignas(64) std::atomic<unsigned> next_{0};
+    alignas(64) std::atomic<unsigned> serving_{0};
+};
+
+// MCS queue lock: FIFO, and every waiter spins on its own queue node instead of the
+// shared lock word. The node is thread-local, so a thread may hold only one MCSLock
+// at a time.
+class MCSLock {
+public:
+    void lock() {
+        Node &me = node();
+        me.next.store(nullptr, std::memory_order_relaxed);
+        me.locked.store(true, std::memory_order_relaxed);
+        Node *prev = tail_.exchange(&me, std::memory_order_acq_rel);
+        if (prev) {
+            prev->next.store(&me, std::memory_order_release);
+            SpinWait sw;
+            while (me.locked.load(std::memory_order_acquire)) sw.wait();
+        }
+    }
+
+    void unlock() {
+        Node &me = node();
+        Node *succ = me.next.load(std::memory_order_acquire);
+        if (!succ) {
+            // No known successor: try to swing the tail back to empty
+            Node *expected = &me;
+            if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) return;
+            // A successor is enqueueing; wait for it to link itself in
+            SpinWait sw;
+            while (!(succ = me.next.load(std::memory_order_acquire))) sw.wait();
+        }
+        succ->locked.store(false, std::memory_order_release);
+    }
+
+private:
+    struct alignas(64) Node {
+        std::atomic<Node *> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    static Node &node() {
+        thread_local Node n;
+        return n;
+    }
+
+    alignas(64) std::atomic<Node *> tail_{nullptr};
+};
+
+// Adaptive lock: spin briefly, then sleep in the kernel on a futex.
+// State 0 = unlocked, 1 = locked, 2 = locked with (possible) sleepers.
+class FutexLock {
+public:
+    void lock() {
+        int c = 0;
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            c = 0;
+            if (state_.compare_exchange_weak(c, 1, std::memory_order_acquire, std::memory_order_relaxed)) return;
+            if (c == 2) break;   // Others are already sleeping; queue up behind them
+            cpu_relax();
+        }
+        if (c != 2) c = state_.exchange(2, std::memory_order_acquire);
+        while (c != 0) {
+            futex(FUTEX_WAIT_PRIVATE, 2);
+            c = state_.exchange(2, std::memory_order_acquire);
+        }
+    }
+
+    void unlock() {
+        if (state_.fetch_sub(1, std::memory_order_release) != 1) {
+            state_.store(0, std::memory_order_release);
+            futex(FUTEX_WAKE_PRIVATE, 1);
+        }
+    }
+
+private:
+    static constexpr int SPIN_LIMIT = 100;
+
+    void futex(int op, int val) {
+        syscall(SYS_futex, reinterpret_cast<int *>(&state_), op, val, nullptr, nullptr, 0);
+    }
+
+    std::atomic<int> state_{0};
+    static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex word must be a plain int");
+};
+
+#endif // LOCKS_H
@@ -1,14 +1,15 @@
 #include <iostream>
 #include <thread>
 #include <mutex>
+#include "profiled_mutex.h"
 
-std::mutex mtx; // Shared mutex
+ProfiledMutex mtx("mtx"); // Shared mutex (a plain std::mutex unless built with PROFILE_LOCKS)
 
 void critical_section(int thread_id) {
     std::cout << "Thread " << thread_id << " trying to lock the mutex.\n";
 
-    // Lock the mutex using std::lock_guard
-    std::lock_guard<std::mutex> lock(mtx);
+    // Lock the mutex using a lock guard (ProfiledLock also records this call site)
+    ProfiledLock<ProfiledMutex> lock(mtx);
 
     // Critical section (only one thread can execute this at a time)
     std::cout << "Thread " << thread_id << " has locked the mutex.\n";
@@ -0,0 +1,244 @@
+#ifndef PROFILED_MUTEX_H
+#define PROFILED_MUTEX_H
+
+// Drop-in instrumented mutex.
+//
+// Build with -DPROFILE_LOCKS to record, per mutex, the number of acquisitions, how many
+// of them had to wait, log2 histograms of wait and hold times, and the call sites that
+// spent the most time waiting. A report is printed to stderr at exit.
+//
+// Without PROFILE_LOCKS, ProfiledMutex is a plain std::mutex and ProfiledLock a plain
+// lock guard, so the instrumentation costs nothing.
+//
+// Usage:
+//     ProfiledMutex mtx("cout_mutex");
+//     ProfiledLock<ProfiledMutex> lock(mtx);   // records the call site
+
+#include <mutex>
+#include <source_location>
+
+#ifndef PROFILE_LOCKS
+
+class ProfiledMutex : public std::mutex {
+public:
+    explicit ProfiledMutex(const char * = nullptr) {}
+};
+
+template <typename Mutex>
+class ProfiledLock {
+public:
+    explicit ProfiledLock(Mutex &m, std::source_location = std::source_location::current()) : lock_(m) {}
+
+private:
+    std::lock_guard<Mutex> lock_;
+};
+
+#else // PROFILE_LOCKS
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace lockprof {
+
+constexpr int BUCKETS = 40;   // Bucket i counts durations in [2^i, 2^(i+1)) ns
+
+inline std::uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline int bucket(std::uint64_t ns) {
+    int b = ns ? 63 - __builtin_clzll(ns) : 0;
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+struct Histogram {
+    std::array<std::atomic<std::uint64_t>, BUCKETS> counts{};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+
+    void add(std::uint64_t ns) {
+        counts[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        std::uint64_t prev = max_ns.load(std::memory_order_relaxed);
+        while (ns > prev && !max_ns.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Upper bound of the bucket holding the given quantile
+    std::uint64_t quantile(double q) const {
+        std::uint64_t n = 0;
+        for (auto &c : counts) n += c.load();
+        if (n == 0) return 0;
+        std::uint64_t target = static_cast<std::uint64_t>(q * (n - 1)), seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[i].load();
+            if (seen > target) return 2ull << i;
+        }
+        return max_ns.load();
+    }
+};
+
+struct SiteStats {
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0;
+    std::uint64_t wait_ns = 0;
+};
+
+struct MutexStats {
+    std::string name;
+    std::atomic<std::uint64_t> acquisitions{0};
+    std::atomic<std::uint64_t> contended{0};
+    Histogram wait;
+    Histogram hold;
+
+    // Per call site (file, line). Written by the owner of the profiled mutex, but the
+    // exit report can run while some thread still holds it, so sites_mtx guards the map
+    std::mutex sites_mtx;
+    std::map<std::pair<const char *, unsigned>, SiteStats> sites;
+};
+
+// Every profiled mutex registers here so the exit report can find it; stats are
+// heap-allocated and never freed, so the report also covers mutexes already destroyed
+struct Registry {
+    std::mutex mtx;
+    std::vector<MutexStats *> all;
+
+    static Registry &get() {
+        static Registry *r = new Registry;
+        return *r;
+    }
+};
+
+inline void print_histogram(const char *label, const Histogram &h) {
+    fprintf(stderr, "    %s: p50 <%lluns p99 <%lluns max %lluns total %.3fms\n", label,
+            (unsigned long long)h.quantile(0.5), (unsigned long long)h.quantile(0.99),
+            (unsigned long long)h.max_ns.load(), h.total_ns.load() / 1e6);
+    for (int i = 0; i < BUCKETS; ++i) {
+        std::uint64_t c = h.counts[i].load();
+        if (c) fprintf(stderr, "      [%llu, %llu) ns: %llu\n", 1ull << i, 2ull << i, (unsigned long long)c);
+    }
+}
+
+inline void report() {
+    Registry &r = Registry::get();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    fprintf(stderr, "\n=== Lock contention report ===\n");
+    for (MutexStats *m : r.all) {
+        std::uint64_t acq = m->acquisitions.load();
+        if (acq == 0) continue;
+        std::uint64_t cont = m->contended.load();
+        fprintf(stderr, "%s: %llu acquisitions, %llu contended (%.1f%%)\n", m->name.c_str(),
+                (unsigned long long)acq, (unsigned long long)cont, 100.0 * cont / acq);
+        print_histogram("wait", m->wait);
+        print_histogram("hold", m->hold);
+
+        // Top contending call sites by total wait time
+        std::vector<std::pair<std::pair<const char *, unsigned>, SiteStats>> sites;
+        {
+            std::lock_guard<std::mutex> sites_lock(m->sites_mtx);
+            sites.assign(m->sites.begin(), m->sites.end());
+        }
+        std::sort(sites.begin(), sites.end(),
+                  [](const auto &a, const auto &b) { return a.second.wait_ns > b.second.wait_ns; });
+        if (sites.size() > 5) sites.resize(5);
+        fprintf(stderr, "    top call sites by wait time:\n");
+        for (auto &s : sites)
+            fprintf(stderr, "      %s:%u: %llu acquisitions, %llu contended, %.3fms waiting\n", s.first.first, s.first.second,
+                    (unsigned long long)s.second.acquisitions, (unsigned long long)s.second.contended,
+                    s.second.wait_ns / 1e6);
+    }
+}
+
+inline MutexStats *register_mutex(const char *name) {
+    Registry &r = Registry::get();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    if (r.all.empty()) atexit(report);
+    MutexStats *m = new MutexStats;
+    m->name = name ? name : "mutex#" + std::to_string(r.all.size());
+    r.all.push_back(m);
+    return m;
+}
+
+} // namespace lockprof
+
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char *name = nullptr) : stats_(lockprof::register_mutex(name)) {}
+    ProfiledMutex(const ProfiledMutex &) = delete;
+    ProfiledMutex &operator=(const ProfiledMutex &) = delete;
+
+    void lock(std::source_location loc = std::source_location::current()) {
+        std::uint64_t wait_ns = 0;
+        bool contended = !mtx_.try_lock();
+        if (contended) {
+            std::uint64_t start = lockprof::now_ns();
+            mtx_.lock();
+            wait_ns = lockprof::now_ns() - start;
+        }
+
+        stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (contended) stats_->contended.fetch_add(1, std::memory_order_relaxed);
+        stats_->wait.add(wait_ns);
+        record_site(loc, contended, wait_ns);
+
+        // Hold time starts after the bookkeeping above
+        acquired_at_ = lockprof::now_ns();
+    }
+
+    // A successful try_lock counts as an uncontended acquisition at its call site;
+    // it never waits, so it is not added to the wait histogram
+    bool try_lock(std::source_location loc = std::source_location::current()) {
+        if (!mtx_.try_lock()) return false;
+        stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        record_site(loc, false, 0);
+        acquired_at_ = lockprof::now_ns();
+        return true;
+    }
+
+    void unlock() {
+        stats_->hold.add(lockprof::now_ns() - acquired_at_);
+        mtx_.unlock();
+    }
+
+private:
+    // Only contended while the exit report copies the table
+    void record_site(const std::source_location &loc, bool contended, std::uint64_t wait_ns) {
+        std::lock_guard<std::mutex> sites_lock(stats_->sites_mtx);
+        lockprof::SiteStats &s = stats_->sites[{loc.file_name(), static_cast<unsigned>(loc.line())}];
+        s.acquisitions++;
+        s.contended += contended;
+        s.wait_ns += wait_ns;
+    }
+
+    std::mutex mtx_;
+    lockprof::MutexStats *stats_;
+    std::uint64_t acquired_at_ = 0;   // Only touched by the owner
+};
+
+template <typename Mutex>
+class ProfiledLock {
+public:
+    explicit ProfiledLock(Mutex &m, std::source_location loc = std::source_location::current()) : m_(m) {
+        m_.lock(loc);
+    }
+    ~ProfiledLock() { m_.unlock(); }
+    ProfiledLock(const ProfiledLock &) = delete;
+    ProfiledLock &operator=(const ProfiledLock &) = delete;
+
+private:
+    Mutex &m_;
+};
+
+#endif // PROFILE_LOCKS
+
+#endif // PROFILED_MUTEX_H
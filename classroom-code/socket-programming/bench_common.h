@@ -0,0 +1,198 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// Shared pieces of the TCP/UDP benchmark: wire protocol, socket helpers,
+// latency statistics and CSV output.
+
+#define BENCH_PORT 8081
+#define RUDP_BENCH_PORT 8082   // Reliable-UDP endpoint (see rudp.h)
+
+// Header sizes on the wire (IPv4 and TCP without options)
+constexpr int IPV4_HEADER = 20;
+constexpr int TCP_HEADER = 20;
+constexpr int UDP_HEADER = 8;
+constexpr int UDP_MAX_PAYLOAD = 65507;
+
+// Bench message kinds. A TCP connection starts with a BenchHello naming its kind;
+// every UDP datagram starts with its kind byte.
+enum BenchKind : char {
+    BENCH_PINGPONG = 'P',  // Echo each message back
+    BENCH_STREAM = 'S',    // Sink messages and count bytes
+    BENCH_END = 'E',       // UDP only: reply with the byte count since the last END
+};
+
+struct BenchHello {
+    char kind;
+    std::uint8_t nodelay;   // Server sets TCP_NODELAY on its side too
+    std::uint16_t reserved;
+    std::uint32_t msg_size; // Network byte order
+};
+
+// Loop until all of buf is sent; returns false on error or closed connection
+inline bool send_all(int sock, const void *buf, size_t len) {
+    const char *p = static_cast<const char *>(buf);
+    while (len > 0) {
+        ssize_t n = send(sock, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Loop until len bytes are received; returns false on error or closed connection
+inline bool recv_all(int sock, void *buf, size_t len) {
+    char *p = static_cast<char *>(buf);
+    while (len > 0) {
+        ssize_t n = recv(sock, p, len, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Apply SO_SNDBUF / SO_RCVBUF when non-zero
+inline void set_socket_buffers(int sock, int sndbuf, int rcvbuf) {
+    if (sndbuf > 0 && setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) < 0)
+        perror("setsockopt(SO_SNDBUF) failed");
+    if (rcvbuf > 0 && setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0)
+        perror("setsockopt(SO_RCVBUF) failed");
+}
+
+inline sockaddr_in make_addr(const std::string &ip, int port) {
+    sockaddr_in addr;
+    std::fill_n(reinterpret_cast<char *>(&addr), sizeof(addr), 0);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (ip.empty())
+        addr.sin_addr.s_addr = INADDR_ANY;
+    else
+        inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
+    return addr;
+}
+
+inline std::uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Bytes on the wire for one TCP message of `payload` bytes split into `mss`-sized segments
+inline long tcp_wire_size(long payload, int mss) {
+    long segments = (payload + mss - 1) / mss;
+    return payload + segments * (IPV4_HEADER + TCP_HEADER);
+}
+
+// Bytes on the wire for one UDP datagram, including IP fragmentation at a 1500-byte MTU
+inline long udp_wire_size(long payload) {
+    long ip_payload = payload + UDP_HEADER;
+    long fragments = (ip_payload + 1479) / 1480;
+    return ip_payload + fragments * IPV4_HEADER;
+}
+
+// Bytes on the wire for one reliable-UDP message: each fragment is its own datagram
+inline long rudp_wire_size(long payload, long max_fragment, long header) {
+    long fragments = payload > 0 ? (payload + max_fragment - 1) / max_fragment : 1;
+    return payload + fragments * (header + UDP_HEADER + IPV4_HEADER);
+}
+
+// Latency summary over a set of samples in nanoseconds
+struct LatencyStats {
+    double p50_us = 0, p90_us = 0, p99_us = 0, p999_us = 0, max_us = 0, mean_us = 0;
+};
+
+inline LatencyStats summarize(std::vector<std::uint64_t> &samples) {
+    LatencyStats s;
+    if (samples.empty())
+        return s;
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) {
+        size_t idx = static_cast<size_t>(p * (samples.size() - 1));
+        return samples[idx] / 1000.0;
+    };
+    double sum = 0;
+    for (std::uint64_t v : samples) sum += v;
+    s.p50_us = pct(0.50);
+    s.p90_us = pct(0.90);
+    s.p99_us = pct(0.99);
+    s.p999_us = pct(0.999);
+    s.max_us = samples.back() / 1000.0;
+    s.mean_us = sum / samples.size() / 1000.0;
+    return s;
+}
+
+// One CSV row of benchmark output
+struct BenchResult {
+    std::string proto;
+    std::string test;
+    long msg_size = 0;
+    long wire_size = 0;
+    int nodelay = 0;
+    int sndbuf = 0;
+    int rcvbuf = 0;
+    int flows = 1;
+    long messages = 0;
+    LatencyStats latency;
+    double throughput_mbps = 0;  // Payload goodput in megabits per second
+    double msgs_per_sec = 0;
+    double loss_pct = 0;
+    long retransmits = 0;        // TCP segments (from TCP_INFO) or reliable-UDP packets resent
+};
+
+inline const char *csv_header() {
+    return "proto,test,msg_size,wire_size,nodelay,sndbuf,rcvbuf,flows,messages,"
+           "p50_us,p90_us,p99_us,p999_us,max_us,mean_us,throughput_mbps,msgs_per_sec,loss_pct,retransmits";
+}
+
+inline std::string csv_row(const BenchResult &r) {
+    std::ostringstream out;
+    out << r.proto << ',' << r.test << ',' << r.msg_size << ',' << r.wire_size << ','
+        << r.nodelay << ',' << r.sndbuf << ',' << r.rcvbuf << ',' << r.flows << ','
+        << r.messages << ',' << r.latency.p50_us << ',' << r.latency.p90_us << ','
+        << r.latency.p99_us << ',' << r.latency.p999_us << ',' << r.latency.max_us << ','
+        << r.latency.mean_us << ',' << r.throughput_mbps << ',' << r.msgs_per_sec << ','
+        << r.loss_pct << ',' << r.retransmits;
+    return out.str();
+}
+
+// Parse a comma separated list such as "16,256,4096"
+inline std::vector<long> parse_list(const std::string &s) {
+    std::vector<long> values;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) values.push_back(atol(item.c_str()));
+    return values;
+}
+
+inline std::vector<std::string> parse_names(const std::string &s) {
+    std::vector<std::string> names;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) names.push_back(item);
+    return names;
+}
+
+#endif // BENCH_COMMON_H
@@ -3,10 +3,63 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <string>
+#include "file_transfer.h"
 
 #define PORT 8080
 
-int main() {
+// File transfer mode: send the file's size, then its bytes, then wait for the server's count
+int send_file(int sock, const std::string &path, const std::string &mode) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        perror("Could not open file");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror("Could not stat file");
+        close(fd);
+        return -1;
+    }
+    std::uint64_t file_size = st.st_size;
+
+    TransferClock start = TransferClock::now();
+    std::uint64_t header = htobe64(file_size);
+    if (!write_all_fd(sock, reinterpret_cast<const char *>(&header), sizeof(header), true) ||
+        !send_file_data(sock, fd, file_size, mode)) {
+        perror("File send failed");
+        close(fd);
+        return -1;
+    }
+
+    std::uint64_t stored = 0;
+    if (!read_exact(sock, &stored, sizeof(stored)) || be64toh(stored) != file_size) {
+        std::cerr << "Server did not confirm the whole file" << std::endl;
+        close(fd);
+        return -1;
+    }
+    TransferClock end = TransferClock::now();
+    print_transfer_report("Sent", mode, file_size, start, end);
+
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // Optional file transfer mode: --send FILE [--mode rw|sendfile|splice]
+    std::string send_path, mode = "sendfile";
+    bool args_ok = argc % 2 == 1;
+    for (int i = 1; args_ok && i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--send") send_path = argv[i + 1];
+        else if (arg == "--mode") mode = argv[i + 1];
+        else args_ok = false;
+    }
+    if (!args_ok || (mode != "rw" && mode != "sendfile" && mode != "splice")) {
+        std::cerr << "Usage: " << argv[0] << " [--send FILE [--mode rw|sendfile|splice]]" << std::endl;
+        return -1;
+    }
+
     int sock = 0;
     struct sockaddr_in serv_addr;
     const char* hello = "Hello from client";
@@ -33,6 +86,12 @@ int main() {
         return -1;
     }
 
+    if (!send_path.empty()) {
+        int result = send_file(sock, send_path, mode);
+        close(sock);
+        return result;
+    }
+
     send(sock, hello, strlen(hello), 0);
     std::cout << "Hello message sent" << std::endl;
 
@@ -5,6 +5,14 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <chrono>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include <endian.h>
+#include <netinet/tcp.h>
+#include "bench_common.h"
+#include "rudp.h"
 
 #define SERVER_PORT 8080
 #define BUFFER_SIZE 1024
@@ -39,7 +47,7 @@ void send_via_tcp(const std::string &server_ip, const std::string &message) {
         std::cout << "TCP: Sent " << sent_bytes << " bytes in "
                   << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count()
                   << " microseconds.\n";
-        std::cout << "TCP: Packet size (including headers) is " << (sent_bytes + 20) << " bytes\n";
+        std::cout << "TCP: Packet size (including IPv4 + TCP headers) is " << (sent_bytes + IPV4_HEADER + TCP_HEADER) << " bytes\n";
     }
 
     close(sockfd);
@@ -70,13 +78,558 @@ void send_via_udp(const std::string &server_ip, const std::string &message) {
         std::cout << "UDP: Sent " << sent_bytes << " bytes in "
                   << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count()
                   << " microseconds.\n";
-        std::cout << "UDP: Packet size (including headers) is " << (sent_bytes + 8) << " bytes\n";
+        std::cout << "UDP: Packet size (including IPv4 + UDP headers) is " << (sent_bytes + IPV4_HEADER + UDP_HEADER) << " bytes\n";
     }
 
     close(sockfd);
 }
 
-int main() {
+// ---------------------------------------------------------------------------
+// Benchmark mode: message-size sweeps, ping-pong RTT percentiles, streaming
+// throughput, TCP_NODELAY on/off, socket buffer sizes and concurrent flows.
+// Runs against `server_compare --bench` and prints CSV.
+//
+// Besides TCP and plain UDP, proto "rudp" runs the same tests over the reliable
+// UDP transport in rudp.h. Its artificial loss (--loss) only affects rudp; to
+// give TCP the same loss, apply it to the interface instead, e.g.
+//     tc qdisc add dev lo root netem loss 1%
+// ---------------------------------------------------------------------------
+
+struct BenchConfig {
+    std::string server_ip = "127.0.0.1";
+    std::vector<std::string> protos = {"tcp", "udp", "rudp"};
+    std::vector<std::string> tests = {"pingpong", "stream"};
+    std::vector<long> sizes = {16, 64, 256, 1024, 4096, 16384};
+    std::vector<long> nodelay = {0, 1};
+    std::vector<long> flows = {1};
+    int sndbuf = 0;
+    int rcvbuf = 0;
+    long iterations = 10000;   // Ping-pong round trips per flow
+    long warmup = 100;         // Round trips not counted in the statistics
+    double duration = 2.0;     // Seconds of streaming per flow
+    int udp_timeout_ms = 200;  // A UDP ping without a reply within this is counted as lost
+    int streams = 1;           // rudp: independent streams, one ping in flight on each
+    RudpOptions rudp;          // rudp: loss, window and pacing of the client side
+    std::string output;        // CSV file, stdout if empty
+};
+
+// What one flow measured
+struct FlowResult {
+    std::vector<std::uint64_t> samples;  // Round trip times in ns
+    long messages = 0;                   // Messages sent
+    long lost = 0;                       // Messages not delivered
+    long bytes_delivered = 0;            // Payload bytes confirmed by the server
+    long retransmits = 0;
+    double seconds = 0;
+    long wire_size = 0;
+    bool ok = true;
+};
+
+static int connect_tcp(const BenchConfig &cfg, long msg_size, bool nodelay, BenchKind kind) {
+    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sockfd < 0) {
+        perror("TCP socket creation failed");
+        return -1;
+    }
+    set_socket_buffers(sockfd, cfg.sndbuf, cfg.rcvbuf);
+    int flag = nodelay ? 1 : 0;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    sockaddr_in server_addr = make_addr(cfg.server_ip, BENCH_PORT);
+    if (connect(sockfd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("TCP connection failed");
+        close(sockfd);
+        return -1;
+    }
+
+    BenchHello hello{kind, static_cast<std::uint8_t>(flag), 0, htonl(static_cast<std::uint32_t>(msg_size))};
+    if (!send_all(sockfd, &hello, sizeof(hello))) {
+        perror("TCP send failed");
+        close(sockfd);
+        return -1;
+    }
+    return sockfd;
+}
+
+static int tcp_mss(int sockfd) {
+    int mss = 0;
+    socklen_t len = sizeof(mss);
+    if (getsockopt(sockfd, IPPROTO_TCP, TCP_MAXSEG, &mss, &len) < 0 || mss <= 0)
+        mss = 1460;
+    return mss;
+}
+
+static long tcp_retransmits(int sockfd) {
+    tcp_info info;
+    socklen_t len = sizeof(info);
+    if (getsockopt(sockfd, IPPROTO_TCP, TCP_INFO, &info, &len) < 0)
+        return 0;
+    return info.tcpi_total_retrans;
+}
+
+static FlowResult tcp_pingpong_flow(const BenchConfig &cfg, long msg_size, bool nodelay) {
+    FlowResult r;
+    int sockfd = connect_tcp(cfg, msg_size, nodelay, BENCH_PINGPONG);
+    if (sockfd < 0) {
+        r.ok = false;
+        return r;
+    }
+    r.wire_size = tcp_wire_size(msg_size, tcp_mss(sockfd));
+
+    std::vector<char> buffer(msg_size, 'x');
+    r.samples.reserve(cfg.iterations);
+    std::uint64_t start = now_ns();
+    for (long i = 0; i < cfg.warmup + cfg.iterations; ++i) {
+        if (i == cfg.warmup) start = now_ns();
+        std::uint64_t t0 = now_ns();
+        if (!send_all(sockfd, buffer.data(), msg_size) || !recv_all(sockfd, buffer.data(), msg_size)) {
+            perror("TCP ping-pong failed");
+            r.ok = false;
+            break;
+        }
+        if (i >= cfg.warmup) {
+            r.samples.push_back(now_ns() - t0);
+            r.messages++;
+            r.bytes_delivered += msg_size;
+        }
+    }
+    r.seconds = (now_ns() - start) / 1e9;
+    r.retransmits = tcp_retransmits(sockfd);
+    close(sockfd);
+    return r;
+}
+
+static FlowResult tcp_stream_flow(const BenchConfig &cfg, long msg_size, bool nodelay) {
+    FlowResult r;
+    int sockfd = connect_tcp(cfg, msg_size, nodelay, BENCH_STREAM);
+    if (sockfd < 0) {
+        r.ok = false;
+        return r;
+    }
+    r.wire_size = tcp_wire_size(msg_size, tcp_mss(sockfd));
+
+    std::vector<char> buffer(msg_size, 'x');
+    std::uint64_t start = now_ns();
+    std::uint64_t stop = start + static_cast<std::uint64_t>(cfg.duration * 1e9);
+    while (now_ns() < stop) {
+        if (!send_all(sockfd, buffer.data(), msg_size)) {
+            perror("TCP send failed");
+            r.ok = false;
+            break;
+        }
+        r.messages++;
+    }
+
+    // The server replies with its byte count once it has read everything
+    shutdown(sockfd, SHUT_WR);
+    std::uint64_t received = 0;
+    if (recv_all(sockfd, &received, sizeof(received)))
+        r.bytes_delivered = static_cast<long>(be64toh(received));
+    else
+        r.ok = false;
+    r.seconds = (now_ns() - start) / 1e9;
+    r.retransmits = tcp_retransmits(sockfd);
+    close(sockfd);
+    return r;
+}
+
+static int open_udp(const BenchConfig &cfg) {
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0) {
+        perror("UDP socket creation failed");
+        return -1;
+    }
+    set_socket_buffers(sockfd, cfg.sndbuf, cfg.rcvbuf);
+
+    // Connected UDP socket: plain send/recv and only the server's replies are delivered
+    sockaddr_in server_addr = make_addr(cfg.server_ip, BENCH_PORT);
+    if (connect(sockfd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("UDP connect failed");
+        close(sockfd);
+        return -1;
+    }
+
+    timeval tv{cfg.udp_timeout_ms / 1000, (cfg.udp_timeout_ms % 1000) * 1000};
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return sockfd;
+}
+
+static FlowResult udp_pingpong_flow(const BenchConfig &cfg, long msg_size) {
+    FlowResult r;
+    int sockfd = open_udp(cfg);
+    if (sockfd < 0) {
+        r.ok = false;
+        return r;
+    }
+    r.wire_size = udp_wire_size(msg_size);
+
+    // Each ping carries its sequence number so late replies to timed-out pings are discarded
+    std::vector<char> buffer(msg_size, 'x'), reply(msg_size);
+    buffer[0] = BENCH_PINGPONG;
+    r.samples.reserve(cfg.iterations);
+    std::uint64_t start = now_ns();
+    for (long i = 0; i < cfg.warmup + cfg.iterations; ++i) {
+        if (i == cfg.warmup) start = now_ns();
+        std::uint64_t seq = i;
+        memcpy(buffer.data() + 1, &seq, sizeof(seq));
+
+        std::uint64_t t0 = now_ns();
+        if (send(sockfd, buffer.data(), msg_size, 0) < 0) {
+            perror("UDP send failed");
+            r.ok = false;
+            break;
+        }
+
+        bool answered = false;
+        while (true) {
+            ssize_t n = recv(sockfd, reply.data(), msg_size, 0);
+            if (n < 0) break;  // Timed out
+            std::uint64_t got;
+            memcpy(&got, reply.data() + 1, sizeof(got));
+            if (n == msg_size && got == seq) {
+                answered = true;
+                break;
+            }
+        }
+
+        if (i >= cfg.warmup) {
+            r.messages++;
+            if (answered) {
+                r.samples.push_back(now_ns() - t0);
+                r.bytes_delivered += msg_size;
+            } else {
+                r.lost++;
+            }
+        }
+    }
+    r.seconds = (now_ns() - start) / 1e9;
+    close(sockfd);
+    return r;
+}
+
+static FlowResult udp_stream_flow(const BenchConfig &cfg, long msg_size) {
+    FlowResult r;
+    int sockfd = open_udp(cfg);
+    if (sockfd < 0) {
+        r.ok = false;
+        return r;
+    }
+    r.wire_size = udp_wire_size(msg_size);
+
+    std::vector<char> buffer(msg_size, 'x');
+    buffer[0] = BENCH_STREAM;
+    std::uint64_t start = now_ns();
+    std::uint64_t stop = start + static_cast<std::uint64_t>(cfg.duration * 1e9);
+    while (now_ns() < stop) {
+        if (send(sockfd, buffer.data(), msg_size, 0) < 0) {
+            if (errno == ENOBUFS || errno == ECONNREFUSED) continue;
+            perror("UDP send failed");
+            r.ok = false;
+            break;
+        }
+        r.messages++;
+    }
+    r.seconds = (now_ns() - start) / 1e9;
+
+    // Ask the server how much arrived; the END datagram itself may be lost, so retry
+    char end = BENCH_END;
+    std::uint64_t received = 0;
+    bool answered = false;
+    for (int attempt = 0; attempt < 5 && !answered; ++attempt) {
+        send(sockfd, &end, 1, 0);
+        answered = recv(sockfd, &received, sizeof(received), 0) == sizeof(received);
+    }
+    if (answered) {
+        r.bytes_delivered = static_cast<long>(be64toh(received));
+        r.lost = r.messages - r.bytes_delivered / msg_size;
+    } else {
+        std::cerr << "UDP: no byte count from server\n";
+        r.ok = false;
+    }
+    close(sockfd);
+    return r;
+}
+
+static int open_rudp(const BenchConfig &cfg) {
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0) {
+        perror("UDP socket creation failed");
+        return -1;
+    }
+    set_socket_buffers(sockfd, cfg.sndbuf ? cfg.sndbuf : RUDP_SOCKET_BUFFER, cfg.rcvbuf ? cfg.rcvbuf : RUDP_SOCKET_BUFFER);
+    sockaddr_in server_addr = make_addr(cfg.server_ip, RUDP_BENCH_PORT);
+    if (connect(sockfd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("UDP connect failed");
+        close(sockfd);
+        return -1;
+    }
+    return sockfd;
+}
+
+// Give up on a reliable-UDP flow when nothing has been delivered for this long
+constexpr std::uint64_t RUDP_STALL_NS = 5000000000ull;
+
+static FlowResult rudp_pingpong_flow(const BenchConfig &cfg, long msg_size) {
+    FlowResult r;
+    int sockfd = open_rudp(cfg);
+    if (sockfd < 0) {
+        r.ok = false;
+        return r;
+    }
+    r.wire_size = rudp_wire_size(msg_size, RUDP_MAX_PAYLOAD, RUDP_HEADER_SIZE);
+    RudpConnection conn(sockfd, make_addr(cfg.server_ip, RUDP_BENCH_PORT), cfg.rudp, sockfd);
+
+    // One ping in flight per stream; a loss on one stream only delays that stream's pings
+    long total = cfg.warmup + cfg.iterations;
+    long next = 0, done = 0;
+    std::vector<char> buffer(msg_size, 'x');
+    buffer[0] = BENCH_PINGPONG;
+    std::vector<std::uint64_t> sent_at(cfg.streams);
+    auto send_ping = [&](int stream) {
+        std::uint64_t seq = next++;
+        memcpy(buffer.data() + 1, &seq, sizeof(seq));
+        sent_at[stream] = now_ns();
+        conn.send_message(stream, buffer.data(), msg_size);
+    };
+
+    r.samples.reserve(cfg.iterations);
+    std::uint64_t start = now_ns(), last_progress = start;
+    for (int stream = 0; stream < cfg.streams && next < total; ++stream) send_ping(stream);
+    while (done < total) {
+        rudp_pump(conn, sockfd, 1000000);
+        RudpMessage reply;
+        while (conn.poll_message(reply)) {
+            if (reply.data.size() != static_cast<size_t>(msg_size) || reply.stream >= cfg.streams) continue;
+            std::uint64_t seq;
+            memcpy(&seq, reply.data.data() + 1, sizeof(seq));
+            if (static_cast<long>(seq) == cfg.warmup) start = now_ns();
+            if (static_cast<long>(seq) >= cfg.warmup) {
+                r.samples.push_back(now_ns() - sent_at[reply.stream]);
+                r.messages++;
+                r.bytes_delivered += msg_size;
+            }
+            done++;
+            last_progress = now_ns();
+            if (next < total) send_ping(reply.stream);
+        }
+        if (now_ns() - last_progress > RUDP_STALL_NS) {
+            std::cerr << "rudp: no reply from server\n";
+            r.ok = false;
+            break;
+        }
+    }
+    r.seconds = (now_ns() - start) / 1e9;
+    r.retransmits = conn.stats().retransmits;
+    close(sockfd);
+    return r;
+}
+
+static FlowResult rudp_stream_flow(const BenchConfig &cfg, long msg_size) {
+    FlowResult r;
+    int sockfd = open_rudp(cfg);
+    if (sockfd < 0) {
+        r.ok = false;
+        return r;
+    }
+    r.wire_size = rudp_wire_size(msg_size, RUDP_MAX_PAYLOAD, RUDP_HEADER_SIZE);
+    RudpConnection conn(sockfd, make_addr(cfg.server_ip, RUDP_BENCH_PORT), cfg.rudp, sockfd);
+
+    // Keep about two windows of packets queued; beyond that, wait for ACKs
+    size_t backlog = 2 * cfg.rudp.max_inflight;
+    std::vector<char> buffer(msg_size, 'x');
+    buffer[0] = BENCH_STREAM;
+    std::uint64_t start = now_ns();
+    std::uint64_t stop = start + static_cast<std::uint64_t>(cfg.duration * 1e9);
+    while (now_ns() < stop) {
+        if (conn.unacked() < backlog) {
+            conn.send_message(r.messages % cfg.streams, buffer.data(), msg_size);
+            r.messages++;
+            rudp_pump(conn, sockfd, 0);
+        } else {
+            rudp_pump(conn, sockfd, 1000000);
+        }
+    }
+
+    // Delivery is reliable: the run ends once the server has acknowledged every packet
+    std::uint64_t last_progress = now_ns();
+    size_t left = conn.unacked();
+    while (left > 0) {
+        rudp_pump(conn, sockfd, 1000000);
+        if (conn.unacked() < left) {
+            left = conn.unacked();
+            last_progress = now_ns();
+        } else if (now_ns() - last_progress > RUDP_STALL_NS) {
+            std::cerr << "rudp: server stopped acknowledging\n";
+            r.ok = false;
+            break;
+        }
+    }
+    r.seconds = (now_ns() - start) / 1e9;
+    if (r.ok) r.bytes_delivered = r.messages * msg_size;
+    r.retransmits = conn.stats().retransmits;
+    close(sockfd);
+    return r;
+}
+
+// Run one benchmark case with `flows` concurrent flows and merge their results
+static BenchResult run_case(const BenchConfig &cfg, const std::string &proto, const std::string &test,
+                            long msg_size, bool nodelay, int flows) {
+    std::vector<FlowResult> results(flows);
+    std::vector<std::thread> threads;
+    std::atomic<int> ready{0};
+
+    for (int f = 0; f < flows; ++f) {
+        threads.emplace_back([&, f] {
+            // Start all flows together
+            ready++;
+            while (ready.load() < flows) std::this_thread::yield();
+
+            if (proto == "tcp" && test == "pingpong") results[f] = tcp_pingpong_flow(cfg, msg_size, nodelay);
+            else if (proto == "tcp") results[f] = tcp_stream_flow(cfg, msg_size, nodelay);
+            else if (proto == "rudp" && test == "pingpong") results[f] = rudp_pingpong_flow(cfg, msg_size);
+            else if (proto == "rudp") results[f] = rudp_stream_flow(cfg, msg_size);
+            else if (test == "pingpong") results[f] = udp_pingpong_flow(cfg, msg_size);
+            else results[f] = udp_stream_flow(cfg, msg_size);
+        });
+    }
+    for (auto &t : threads) t.join();
+
+    BenchResult out;
+    out.proto = proto;
+    out.test = test;
+    out.msg_size = msg_size;
+    out.nodelay = (proto == "tcp") ? nodelay : 0;
+    out.sndbuf = cfg.sndbuf;
+    out.rcvbuf = cfg.rcvbuf;
+    out.flows = flows;
+
+    std::vector<std::uint64_t> samples;
+    long lost = 0;
+    double seconds = 0;
+    long bytes = 0;
+    for (auto &r : results) {
+        samples.insert(samples.end(), r.samples.begin(), r.samples.end());
+        out.messages += r.messages;
+        out.wire_size = r.wire_size;
+        lost += r.lost;
+        out.retransmits += r.retransmits;
+        bytes += r.bytes_delivered;
+        seconds = std::max(seconds, r.seconds);
+    }
+    out.latency = summarize(samples);
+    if (seconds > 0) {
+        out.throughput_mbps = bytes * 8.0 / seconds / 1e6;
+        out.msgs_per_sec = (bytes / msg_size) / seconds;
+    }
+    if (out.messages > 0)
+        out.loss_pct = 100.0 * lost / out.messages;
+    return out;
+}
+
+static void print_bench_usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " --bench [options]\n"
+              << "  --server IP         server address (default 127.0.0.1)\n"
+              << "  --proto LIST        tcp,udp,rudp\n"
+              << "  --test LIST         pingpong,stream\n"
+              << "  --sizes LIST        message sizes in bytes (default 16,64,256,1024,4096,16384)\n"
+              << "  --nodelay LIST      TCP_NODELAY values to sweep (default 0,1)\n"
+              << "  --flows LIST        concurrent flow counts to sweep (default 1)\n"
+              << "  --sndbuf BYTES      SO_SNDBUF (default: kernel default)\n"
+              << "  --rcvbuf BYTES      SO_RCVBUF (default: kernel default)\n"
+              << "  --iterations N      ping-pong round trips per flow (default 10000)\n"
+              << "  --warmup N          round trips excluded from statistics (default 100)\n"
+              << "  --duration SEC      streaming time per flow (default 2)\n"
+              << "  --streams N         rudp: streams per flow, one ping in flight on each (default 1)\n"
+              << "  --loss PCT          rudp: drop this percentage of the client's datagrams\n"
+              << "  --window PKTS       rudp: packets in flight (default 256)\n"
+              << "  --pacing MBPS       rudp: pace sends at this rate (default: unpaced)\n"
+              << "  --output FILE       write CSV to FILE instead of stdout\n";
+}
+
+static int run_bench(int argc, char *argv[]) {
+    BenchConfig cfg;
+    static const option long_options[] = {
+        {"server", required_argument, nullptr, 's'},
+        {"proto", required_argument, nullptr, 'p'},
+        {"test", required_argument, nullptr, 't'},
+        {"sizes", required_argument, nullptr, 'z'},
+        {"nodelay", required_argument, nullptr, 'n'},
+        {"flows", required_argument, nullptr, 'f'},
+        {"sndbuf", required_argument, nullptr, 'S'},
+        {"rcvbuf", required_argument, nullptr, 'R'},
+        {"iterations", required_argument, nullptr, 'i'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"output", required_argument, nullptr, 'o'},
+        {"streams", required_argument, nullptr, 'm'},
+        {"loss", required_argument, nullptr, 'l'},
+        {"window", required_argument, nullptr, 'W'},
+        {"pacing", required_argument, nullptr, 'P'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 's': cfg.server_ip = optarg; break;
+        case 'p': cfg.protos = parse_names(optarg); break;
+        case 't': cfg.tests = parse_names(optarg); break;
+        case 'z': cfg.sizes = parse_list(optarg); break;
+        case 'n': cfg.nodelay = parse_list(optarg); break;
+        case 'f': cfg.flows = parse_list(optarg); break;
+        case 'S': cfg.sndbuf = atoi(optarg); break;
+        case 'R': cfg.rcvbuf = atoi(optarg); break;
+        case 'i': cfg.iterations = atol(optarg); break;
+        case 'w': cfg.warmup = atol(optarg); break;
+        case 'd': cfg.duration = atof(optarg); break;
+        case 'o': cfg.output = optarg; break;
+        case 'm': cfg.streams = std::max(1, atoi(optarg)); break;
+        case 'l': cfg.rudp.loss_pct = atof(optarg); break;
+        case 'W': cfg.rudp.max_inflight = std::max(1, atoi(optarg)); break;
+        case 'P': cfg.rudp.pacing_mbps = atof(optarg); break;
+        default:
+            print_bench_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!cfg.output.empty()) {
+        file.open(cfg.output);
+        if (!file) {
+            std::cerr << "Could not open " << cfg.output << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = cfg.output.empty() ? std::cout : file;
+    out << csv_header() << "\n";
+
+    for (const std::string &proto : cfg.protos) {
+        for (const std::string &test : cfg.tests) {
+            // TCP_NODELAY only applies to TCP
+            std::vector<long> nodelay_values = (proto == "tcp") ? cfg.nodelay : std::vector<long>{0};
+            for (long size : cfg.sizes) {
+                // UDP ping-pong needs room for the kind byte and sequence number
+                if (proto == "udp" && (size > UDP_MAX_PAYLOAD || size < 9)) continue;
+                if (proto == "rudp" && size < 9) continue;
+                if (proto == "tcp" && size < 1) continue;
+                for (long nodelay : nodelay_values) {
+                    for (long flows : cfg.flows) {
+                        BenchResult r = run_case(cfg, proto, test, size, nodelay != 0, static_cast<int>(flows));
+                        out << csv_row(r) << std::endl;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return run_bench(argc - 1, argv + 1);
+    }
+
     std::string server_ip = "127.0.0.1"; // Loopback address
     std::string message = "Hello, Network Programming!";
 
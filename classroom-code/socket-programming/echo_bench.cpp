@@ -0,0 +1,125 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include <netinet/tcp.h>
+#include "bench_common.h"
+#include "server_core.h"
+
+// Echo server benchmark: runs the same echo application on the epoll and io_uring
+// backends of the server core and drives each with concurrent ping-pong clients on
+// loopback. Reports request rate, RTT percentiles and server syscalls per request.
+
+#define ECHO_PORT 8090
+
+struct EchoConfig {
+    std::vector<std::string> backends = {"epoll", "uring"};
+    int port = ECHO_PORT;
+    int clients = 8;
+    long requests = 20000;   // Per client
+    long size = 64;
+};
+
+// One client connection doing request/response round trips
+static void echo_client(const EchoConfig &cfg, std::vector<std::uint64_t> &samples, bool &ok) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = make_addr("127.0.0.1", cfg.port);
+    if (sock < 0 || connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("Connection Failed");
+        ok = false;
+        if (sock >= 0) close(sock);
+        return;
+    }
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::vector<char> buffer(cfg.size, 'x');
+    samples.reserve(cfg.requests);
+    for (long i = 0; i < cfg.requests; ++i) {
+        std::uint64_t t0 = now_ns();
+        if (!send_all(sock, buffer.data(), buffer.size()) || !recv_all(sock, buffer.data(), buffer.size())) {
+            perror("Echo failed");
+            ok = false;
+            break;
+        }
+        samples.push_back(now_ns() - t0);
+    }
+    close(sock);
+}
+
+static bool run_backend(const EchoConfig &cfg, const std::string &backend) {
+    // The echo application: send back whatever arrives
+    DataHandler echo = [](Connection &conn, const char *data, size_t len) { conn.send(data, len); };
+    std::unique_ptr<ServerCore> server = (backend == "uring") ? make_uring_server(echo) : make_epoll_server(echo);
+    if (!server->listen(cfg.port)) return false;
+
+    std::thread server_thread([&server] { server->run(); });
+
+    std::vector<std::vector<std::uint64_t>> samples(cfg.clients);
+    std::vector<char> ok(cfg.clients, true);
+    std::vector<std::thread> clients;
+    std::uint64_t start = now_ns();
+    for (int c = 0; c < cfg.clients; ++c) {
+        clients.emplace_back([&, c] {
+            bool client_ok = true;
+            echo_client(cfg, samples[c], client_ok);
+            ok[c] = client_ok;
+        });
+    }
+    for (auto &t : clients) t.join();
+    double seconds = (now_ns() - start) / 1e9;
+
+    server->stop();
+    server_thread.join();
+
+    std::vector<std::uint64_t> all;
+    for (auto &s : samples) all.insert(all.end(), s.begin(), s.end());
+    LatencyStats lat = summarize(all);
+    const ServerStats &st = server->stats();
+    double requests = static_cast<double>(all.size());
+
+    std::cout << server->name() << ',' << cfg.clients << ',' << cfg.size << ',' << all.size() << ','
+              << seconds << ',' << requests / seconds << ',' << lat.p50_us << ',' << lat.p99_us << ','
+              << st.syscalls << ',' << (requests > 0 ? st.syscalls / requests : 0) << ','
+              << st.bytes_in << ',' << st.bytes_out << std::endl;
+
+    for (char c : ok)
+        if (!c) return false;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    EchoConfig cfg;
+    static const option long_options[] = {
+        {"backend", required_argument, nullptr, 'b'},
+        {"port", required_argument, nullptr, 'p'},
+        {"clients", required_argument, nullptr, 'c'},
+        {"requests", required_argument, nullptr, 'n'},
+        {"size", required_argument, nullptr, 's'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 'b': cfg.backends = parse_names(optarg); break;
+        case 'p': cfg.port = atoi(optarg); break;
+        case 'c': cfg.clients = atoi(optarg); break;
+        case 'n': cfg.requests = atol(optarg); break;
+        case 's': cfg.size = atol(optarg); break;
+        default:
+            std::cerr << "Usage: " << argv[0]
+                      << " [--backend epoll,uring] [--port P] [--clients N] [--requests N] [--size BYTES]\n";
+            return 1;
+        }
+    }
+
+    std::cout << "backend,clients,msg_size,requests,seconds,req_per_sec,p50_us,p99_us,"
+                 "server_syscalls,syscalls_per_req,bytes_in,bytes_out\n";
+    for (const std::string &backend : cfg.backends) {
+        if (!run_backend(cfg, backend)) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+#ifndef FILE_TRANSFER_H
+#define FILE_TRANSFER_H
+
+#include <iostream>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <endian.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Bulk file transfer paths for the classroom client/server pair.
+//
+// Wire format: an 8-byte big-endian file size, then the file bytes. The receiver
+// answers with the 8-byte big-endian count it stored, so the sender can time the
+// whole transfer end to end.
+//
+// Sender paths:   rw (read + send), sendfile, splice (file -> pipe -> socket)
+// Receiver paths: rw (recv + write), splice (socket -> pipe -> file), mmap (recv
+//                 straight into the mmap()ed output file)
+
+constexpr size_t CHUNK_SIZE = 1 << 20;        // Per-call transfer size for every path
+constexpr int PIPE_SIZE = 1 << 20;            // Pipe capacity requested for splice
+
+inline bool write_all_fd(int fd, const char *data, size_t len, bool is_socket) {
+    while (len > 0) {
+        ssize_t n = is_socket ? send(fd, data, len, MSG_NOSIGNAL) : write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+inline bool read_exact(int fd, void *buf, size_t len) {
+    char *p = static_cast<char *>(buf);
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, MSG_WAITALL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Pipe for splice, enlarged so each splice call can move a full chunk
+inline bool make_splice_pipe(int fds[2]) {
+    if (pipe(fds) < 0) {
+        perror("pipe failed");
+        return false;
+    }
+    fcntl(fds[1], F_SETPIPE_SZ, PIPE_SIZE);
+    return true;
+}
+
+// Move exactly len bytes from in_fd to out_fd through the pipe
+inline bool splice_through(int in_fd, int out_fd, int pipe_fds[2], std::uint64_t len) {
+    while (len > 0) {
+        size_t want = len < CHUNK_SIZE ? len : CHUNK_SIZE;
+        ssize_t in = splice(in_fd, nullptr, pipe_fds[1], nullptr, want, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (in < 0 && errno == EINTR) continue;
+        if (in <= 0) return false;
+
+        ssize_t left = in;
+        while (left > 0) {
+            ssize_t out = splice(pipe_fds[0], nullptr, out_fd, nullptr, left, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (out < 0 && errno == EINTR) continue;
+            if (out <= 0) return false;
+            left -= out;
+        }
+        len -= in;
+    }
+    return true;
+}
+
+// Send file_size bytes of fd to the socket using the chosen path
+inline bool send_file_data(int sock, int fd, std::uint64_t file_size, const std::string &mode) {
+    if (mode == "sendfile") {
+        off_t offset = 0;
+        while (static_cast<std::uint64_t>(offset) < file_size) {
+            std::uint64_t left = file_size - offset;
+            ssize_t n = sendfile(sock, fd, &offset, left < CHUNK_SIZE ? left : CHUNK_SIZE);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+        }
+        return true;
+    }
+
+    if (mode == "splice") {
+        int pipe_fds[2];
+        if (!make_splice_pipe(pipe_fds)) return false;
+        bool ok = splice_through(fd, sock, pipe_fds, file_size);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return ok;
+    }
+
+    // rw: classic read() + send() through a user-space buffer
+    std::vector<char> buffer(CHUNK_SIZE);
+    std::uint64_t left = file_size;
+    while (left > 0) {
+        ssize_t n = read(fd, buffer.data(), left < CHUNK_SIZE ? left : CHUNK_SIZE);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        if (!write_all_fd(sock, buffer.data(), n, true)) return false;
+        left -= n;
+    }
+    return true;
+}
+
+// Receive file_size bytes from the socket into fd using the chosen path
+inline bool recv_file_data(int sock, int fd, std::uint64_t file_size, const std::string &mode) {
+    if (mode == "splice") {
+        int pipe_fds[2];
+        if (!make_splice_pipe(pipe_fds)) return false;
+        bool ok = splice_through(sock, fd, pipe_fds, file_size);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return ok;
+    }
+
+    if (mode == "mmap") {
+        if (file_size == 0) return true;
+        if (ftruncate(fd, file_size) < 0) {
+            perror("ftruncate failed");
+            return false;
+        }
+        void *map = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            perror("mmap failed");
+            return false;
+        }
+        // Large MSG_WAITALL receives land directly in the page cache of the output file
+        char *dst = static_cast<char *>(map);
+        std::uint64_t done = 0;
+        bool ok = true;
+        while (done < file_size) {
+            std::uint64_t left = file_size - done;
+            ssize_t n = recv(sock, dst + done, left < CHUNK_SIZE ? left : CHUNK_SIZE, MSG_WAITALL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            done += n;
+        }
+        munmap(map, file_size);
+        return ok;
+    }
+
+    // rw: classic recv() + write() through a user-space buffer
+    std::vector<char> buffer(CHUNK_SIZE);
+    std::uint64_t left = file_size;
+    while (left > 0) {
+        ssize_t n = recv(sock, buffer.data(), left < CHUNK_SIZE ? left : CHUNK_SIZE, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        if (!write_all_fd(fd, buffer.data(), n, false)) return false;
+        left -= n;
+    }
+    return true;
+}
+
+// Wall clock and CPU time (user + system) of this process
+struct TransferClock {
+    timeval wall;
+    rusage usage;
+
+    static TransferClock now() {
+        TransferClock c;
+        gettimeofday(&c.wall, nullptr);
+        getrusage(RUSAGE_SELF, &c.usage);
+        return c;
+    }
+};
+
+inline double seconds_between(const timeval &a, const timeval &b) {
+    return (b.tv_sec - a.tv_sec) + (b.tv_usec - a.tv_usec) / 1e6;
+}
+
+inline void print_transfer_report(const char *who, const std::string &mode, std::uint64_t bytes,
+                                  const TransferClock &start, const TransferClock &end) {
+    double wall = seconds_between(start.wall, end.wall);
+    double user = seconds_between(start.usage.ru_utime, end.usage.ru_utime);
+    double sys = seconds_between(start.usage.ru_stime, end.usage.ru_stime);
+    double gb = bytes / 1e9;
+
+    std::cout << who << " (" << mode << "): " << bytes << " bytes in " << wall << " s, "
+              << (wall > 0 ? bytes / wall / 1e6 : 0) << " MB/s, CPU user " << user << " s + sys " << sys
+              << " s, " << (gb > 0 ? (user + sys) / gb : 0) << " CPU s/GB" << std::endl;
+}
+
+#endif // FILE_TRANSFER_H
@@ -0,0 +1,295 @@
+#include "rudp.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <endian.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include "bench_common.h"
+
+namespace {
+
+enum RudpType : std::uint8_t {
+    RUDP_DATA = 1,
+    RUDP_ACK = 2,
+};
+
+constexpr std::uint32_t LOSS_THRESHOLD = 3;           // Later packets acked before one counts as lost
+constexpr std::uint64_t INITIAL_RTO_NS = 100000000;   // 100 ms until the first RTT sample
+constexpr std::uint64_t PACING_CREDIT_NS = 200000;     // Burst allowance of the pacer
+
+void put16(char *p, std::uint16_t v) { v = htobe16(v); memcpy(p, &v, 2); }
+void put32(char *p, std::uint32_t v) { v = htobe32(v); memcpy(p, &v, 4); }
+void put64(char *p, std::uint64_t v) { v = htobe64(v); memcpy(p, &v, 8); }
+std::uint16_t get16(const char *p) { std::uint16_t v; memcpy(&v, p, 2); return be16toh(v); }
+std::uint32_t get32(const char *p) { std::uint32_t v; memcpy(&v, p, 4); return be32toh(v); }
+std::uint64_t get64(const char *p) { std::uint64_t v; memcpy(&v, p, 8); return be64toh(v); }
+
+} // namespace
+
+RudpConnection::RudpConnection(int sock, const sockaddr_in &peer, const RudpOptions &opts, unsigned seed)
+    : sock_(sock), peer_(peer), opts_(opts), rng_(seed),
+      rto_(std::clamp(INITIAL_RTO_NS, opts.min_rto_ns, opts.max_rto_ns)) {}
+
+void RudpConnection::send_message(std::uint16_t stream, const char *data, size_t len) {
+    StreamState &s = streams_[stream];
+    std::uint32_t msg_seq = s.next_send_seq++;
+    size_t count = std::max<size_t>(1, (len + RUDP_MAX_PAYLOAD - 1) / RUDP_MAX_PAYLOAD);
+    for (size_t i = 0; i < count; ++i) {
+        size_t off = i * RUDP_MAX_PAYLOAD;
+        size_t n = std::min(RUDP_MAX_PAYLOAD, len - off);
+        send_queue_.push_back(Fragment{stream, msg_seq, static_cast<std::uint16_t>(i),
+                                       static_cast<std::uint16_t>(count), std::string(data + off, n)});
+    }
+}
+
+void RudpConnection::send_datagram(const char *data, size_t len) {
+    if (opts_.loss_pct > 0 && std::uniform_real_distribution<double>(0, 100)(rng_) < opts_.loss_pct) {
+        stats_.dropped++;
+        return;
+    }
+    // A full socket buffer is just another loss; the retransmission timer recovers
+    sendto(sock_, data, len, 0, reinterpret_cast<const sockaddr *>(&peer_), sizeof(peer_));
+}
+
+void RudpConnection::transmit(Fragment frag, std::uint64_t now) {
+    std::uint32_t pkt_num = next_pkt_num_++;
+    char buf[RUDP_MAX_DATAGRAM];
+    buf[0] = RUDP_DATA;
+    buf[1] = 0;
+    put16(buf + 2, frag.stream);
+    put32(buf + 4, pkt_num);
+    put32(buf + 8, frag.msg_seq);
+    put16(buf + 12, frag.frag_idx);
+    put16(buf + 14, frag.frag_count);
+    put32(buf + 16, inflight_.empty() ? pkt_num : inflight_.begin()->first);
+    memcpy(buf + RUDP_HEADER_SIZE, frag.payload.data(), frag.payload.size());
+    size_t len = RUDP_HEADER_SIZE + frag.payload.size();
+    send_datagram(buf, len);
+
+    stats_.data_sent++;
+    if (frag.retransmission) stats_.retransmits++;
+    if (opts_.pacing_mbps > 0) {
+        std::uint64_t gap = static_cast<std::uint64_t>((len + UDP_HEADER + IPV4_HEADER) * 8 * 1e3 / opts_.pacing_mbps);
+        // Late wakeups keep up to PACING_CREDIT_NS of credit instead of losing the rate
+        next_send_at_ = std::max(next_send_at_, now > PACING_CREDIT_NS ? now - PACING_CREDIT_NS : 0) + gap;
+    }
+    inflight_.emplace(pkt_num, SentPacket{std::move(frag), now});
+}
+
+void RudpConnection::send_ack() {
+    std::uint64_t bitmap = 0;
+    for (std::uint32_t p : received_above_) {
+        std::uint32_t bit = p - cum_ack_ - 1;
+        if (bit >= 64) break;
+        bitmap |= 1ull << bit;
+    }
+    char buf[RUDP_HEADER_SIZE];
+    buf[0] = RUDP_ACK;
+    buf[1] = 0;
+    put16(buf + 2, 0);
+    put32(buf + 4, cum_ack_);
+    put64(buf + 8, bitmap);
+    put32(buf + 16, 0);
+    send_datagram(buf, sizeof(buf));
+
+    stats_.acks_sent++;
+    ack_pending_ = false;
+    unacked_data_ = 0;
+}
+
+void RudpConnection::advance_cum_ack() {
+    while (!received_above_.empty() && *received_above_.begin() == cum_ack_) {
+        received_above_.erase(received_above_.begin());
+        cum_ack_++;
+    }
+}
+
+void RudpConnection::on_datagram(const char *data, size_t len, std::uint64_t now) {
+    if (len < RUDP_HEADER_SIZE) return;
+    if (data[0] == RUDP_DATA) handle_data(data, len, now);
+    else if (data[0] == RUDP_ACK) handle_ack(data, len, now);
+}
+
+void RudpConnection::handle_data(const char *data, size_t len, std::uint64_t now) {
+    std::uint16_t stream = get16(data + 2);
+    std::uint32_t pkt_num = get32(data + 4);
+    std::uint32_t msg_seq = get32(data + 8);
+    std::uint16_t frag_idx = get16(data + 12);
+    std::uint16_t frag_count = get16(data + 14);
+    std::uint32_t lowest_outstanding = get32(data + 16);
+    if (frag_count == 0 || frag_idx >= frag_count) return;
+
+    // Packets below the sender's lowest outstanding one were lost and resent under
+    // new numbers; stop waiting for them
+    if (lowest_outstanding > cum_ack_) {
+        cum_ack_ = lowest_outstanding;
+        received_above_.erase(received_above_.begin(), received_above_.lower_bound(cum_ack_));
+        advance_cum_ack();
+    }
+
+    // Acknowledge at once when something looks wrong (duplicate or gap), otherwise
+    // every second packet or after the ACK delay
+    if (pkt_num < cum_ack_ || received_above_.count(pkt_num)) {
+        // Already seen (our ACK was lost) or given up on; the data is handled elsewhere
+        ack_pending_ = true;
+        ack_due_ = now;
+        return;
+    }
+    received_above_.insert(pkt_num);
+    advance_cum_ack();
+    bool ack_now = !received_above_.empty();   // There is a gap below some arrival
+    if (!ack_pending_) {
+        ack_pending_ = true;
+        ack_due_ = now + opts_.ack_delay_ns;
+    }
+    if (ack_now || ++unacked_data_ >= 2) ack_due_ = now;
+
+    // Reassemble; retransmissions can carry fragments of messages already delivered
+    StreamState &s = streams_[stream];
+    if (msg_seq < s.next_deliver_seq) return;
+    PartialMessage &m = s.partial[msg_seq];
+    if (m.frags.empty()) {
+        m.frags.resize(frag_count);
+        m.have.resize(frag_count);
+    }
+    if (frag_idx >= m.frags.size() || m.have[frag_idx]) return;
+    m.frags[frag_idx].assign(data + RUDP_HEADER_SIZE, len - RUDP_HEADER_SIZE);
+    m.have[frag_idx] = true;
+    m.received++;
+
+    // Deliver complete messages in order within this stream only
+    auto it = s.partial.begin();
+    while (it != s.partial.end() && it->first == s.next_deliver_seq && it->second.received == it->second.frags.size()) {
+        RudpMessage msg;
+        msg.stream = stream;
+        for (auto &f : it->second.frags) msg.data += f;
+        delivered_.push_back(std::move(msg));
+        stats_.messages_delivered++;
+        s.next_deliver_seq++;
+        it = s.partial.erase(it);
+    }
+}
+
+void RudpConnection::handle_ack(const char *data, size_t, std::uint64_t now) {
+    std::uint32_t cum = get32(data + 4);
+    std::uint64_t bitmap = get64(data + 8);
+
+    // Remove everything the ACK covers; the newest of those gives the RTT sample
+    bool acked_any = false;
+    std::uint32_t newest = 0;
+    std::uint64_t newest_sent_at = 0;
+    auto ack_one = [&](std::map<std::uint32_t, SentPacket>::iterator it) {
+        if (!acked_any || it->first > newest) {
+            newest = it->first;
+            newest_sent_at = it->second.sent_at;
+        }
+        acked_any = true;
+        return inflight_.erase(it);
+    };
+    auto it = inflight_.begin();
+    while (it != inflight_.end() && it->first < cum) it = ack_one(it);
+    for (int bit = 0; bit < 64 && bitmap; ++bit) {
+        if (!(bitmap & (1ull << bit))) continue;
+        auto found = inflight_.find(cum + 1 + bit);
+        if (found != inflight_.end()) ack_one(found);
+    }
+    if (!acked_any) return;
+
+    if (!any_acked_ || newest > largest_acked_) largest_acked_ = newest;
+    any_acked_ = true;
+    update_rtt(now - newest_sent_at);
+
+    // Anything still in flight well below the largest acknowledged packet was lost
+    std::vector<std::uint32_t> lost;
+    for (auto &p : inflight_) {
+        if (p.first + LOSS_THRESHOLD > largest_acked_) break;
+        lost.push_back(p.first);
+    }
+    requeue_lost(lost);
+}
+
+void RudpConnection::update_rtt(std::uint64_t sample) {
+    // RFC 6298; a fresh sample also undoes any timer backoff
+    if (srtt_ == 0) {
+        srtt_ = sample;
+        rttvar_ = sample / 2;
+    } else {
+        std::uint64_t err = srtt_ > sample ? srtt_ - sample : sample - srtt_;
+        rttvar_ = (3 * rttvar_ + err) / 4;
+        srtt_ = (7 * srtt_ + sample) / 8;
+    }
+    rto_ = std::clamp(srtt_ + 4 * rttvar_, opts_.min_rto_ns, opts_.max_rto_ns);
+}
+
+void RudpConnection::requeue_lost(const std::vector<std::uint32_t> &pkt_nums) {
+    // Retransmissions go ahead of new data, in their original order
+    std::vector<Fragment> frags;
+    for (std::uint32_t pkt_num : pkt_nums) {
+        auto it = inflight_.find(pkt_num);
+        if (it == inflight_.end()) continue;
+        it->second.frag.retransmission = true;
+        frags.push_back(std::move(it->second.frag));
+        inflight_.erase(it);
+    }
+    send_queue_.insert(send_queue_.begin(), std::make_move_iterator(frags.begin()),
+                       std::make_move_iterator(frags.end()));
+}
+
+void RudpConnection::on_tick(std::uint64_t now) {
+    // Retransmission timer: packet numbers grow with send time, so the oldest packet
+    // in flight is the first to expire. Like TCP, resend only that one; once it is
+    // acknowledged, anything older still outstanding counts as lost via the SACKs.
+    if (!inflight_.empty() && now >= inflight_.begin()->second.sent_at + rto_) {
+        stats_.timeouts++;
+        rto_ = std::min(rto_ * 2, opts_.max_rto_ns);
+        requeue_lost({inflight_.begin()->first});
+    }
+
+    while (!send_queue_.empty() && inflight_.size() < opts_.max_inflight &&
+           (opts_.pacing_mbps <= 0 || now >= next_send_at_)) {
+        Fragment frag = std::move(send_queue_.front());
+        send_queue_.pop_front();
+        transmit(std::move(frag), now);
+    }
+
+    if (ack_pending_ && now >= ack_due_) send_ack();
+}
+
+std::uint64_t RudpConnection::next_deadline() const {
+    std::uint64_t deadline = 0;
+    auto consider = [&](std::uint64_t t) {
+        if (deadline == 0 || t < deadline) deadline = t;
+    };
+    if (!inflight_.empty()) consider(inflight_.begin()->second.sent_at + rto_);
+    if (!send_queue_.empty() && inflight_.size() < opts_.max_inflight)
+        consider(opts_.pacing_mbps > 0 ? std::max<std::uint64_t>(next_send_at_, 1) : 1);
+    if (ack_pending_) consider(std::max<std::uint64_t>(ack_due_, 1));
+    return deadline;
+}
+
+bool RudpConnection::poll_message(RudpMessage &out) {
+    if (delivered_.empty()) return false;
+    out = std::move(delivered_.front());
+    delivered_.pop_front();
+    return true;
+}
+
+void rudp_pump(RudpConnection &conn, int sock, std::uint64_t max_wait_ns) {
+    std::uint64_t now = now_ns();
+    std::uint64_t wait = max_wait_ns;
+    std::uint64_t deadline = conn.next_deadline();
+    if (deadline) wait = std::min(wait, deadline > now ? deadline - now : 0);
+
+    pollfd pfd{sock, POLLIN, 0};
+    timespec ts{static_cast<time_t>(wait / 1000000000), static_cast<long>(wait % 1000000000)};
+    if (ppoll(&pfd, 1, &ts, nullptr) > 0) {
+        char buf[RUDP_MAX_DATAGRAM];
+        ssize_t n;
+        while ((n = recv(sock, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+            conn.on_datagram(buf, n, now_ns());
+    }
+    conn.on_tick(now_ns());
+}
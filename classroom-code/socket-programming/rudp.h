@@ -0,0 +1,164 @@
+#ifndef RUDP_H
+#define RUDP_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+// Reliable, message-oriented transport over UDP, used as a third protocol next to TCP
+// and plain UDP in the benchmark.
+//
+//  - Every DATA packet gets a fresh connection-level packet number; retransmitted data
+//    is resent under a new number, so ACKs are never ambiguous and every ACK gives a
+//    clean RTT sample.
+//  - ACKs carry the cumulative packet number plus a 64-bit selective-ACK bitmap.
+//    Because lost data moves to a new packet number, its old number never arrives;
+//    every DATA packet therefore also carries the sender's lowest outstanding packet
+//    number, and the receiver's cumulative ACK skips ahead to it.
+//  - Losses are detected when three later packets are acknowledged, or when the
+//    retransmission timer (RFC 6298 style SRTT/RTTVAR, exponential backoff) fires.
+//  - Sending is limited by a window of packets in flight and optionally paced.
+//  - Messages are split into fragments and delivered whole, in order within their
+//    stream, but independently across streams: a loss on one stream never holds
+//    back messages on another (no head-of-line blocking across streams).
+//
+// A RudpConnection does no I/O of its own besides sendto() on the socket it is given;
+// the owner feeds it datagrams and calls on_tick() from its event loop (rudp_pump()
+// does both for a socket that carries a single connection).
+//
+// Wire format, all fields big-endian, 20-byte header:
+//   DATA: type=1, reserved, stream(16), packet number(32), message seq(32),
+//         fragment index(16), fragment count(16), lowest outstanding(32), payload
+//   ACK:  type=2, reserved, unused(16), cumulative ack(32), SACK bitmap(64) where
+//         bit i set means packet cumulative+1+i has arrived, unused(32)
+// Packet numbers are not wrapped; a connection is good for 2^32 packets.
+
+constexpr size_t RUDP_MAX_PAYLOAD = 1200;    // Message bytes per DATA packet
+constexpr size_t RUDP_HEADER_SIZE = 20;
+constexpr size_t RUDP_MAX_DATAGRAM = RUDP_HEADER_SIZE + RUDP_MAX_PAYLOAD;
+
+// Socket buffer size for rudp sockets unless the user picks one: a full window must
+// fit in the peer's receive buffer, or the burst overflows it and is retransmitted
+constexpr int RUDP_SOCKET_BUFFER = 4 << 20;
+
+struct RudpOptions {
+    double loss_pct = 0;          // Artificial loss applied to every datagram this side sends
+    unsigned max_inflight = 256;  // Window, in packets
+    double pacing_mbps = 0;       // Pacing rate; 0 sends as fast as the window allows
+    std::uint64_t min_rto_ns = 2000000;      // 2 ms
+    std::uint64_t max_rto_ns = 1000000000;   // 1 s
+    std::uint64_t ack_delay_ns = 200000;     // Longest an ACK may be held back
+};
+
+struct RudpMessage {
+    std::uint16_t stream = 0;
+    std::string data;
+};
+
+struct RudpStats {
+    std::uint64_t data_sent = 0;       // DATA packets put on the wire (or artificially dropped)
+    std::uint64_t retransmits = 0;     // Of which were retransmissions
+    std::uint64_t acks_sent = 0;
+    std::uint64_t dropped = 0;         // Datagrams dropped by the artificial loss
+    std::uint64_t timeouts = 0;        // Retransmission timer expiries
+    std::uint64_t messages_delivered = 0;
+};
+
+class RudpConnection {
+public:
+    RudpConnection(int sock, const sockaddr_in &peer, const RudpOptions &opts, unsigned seed = 1);
+
+    // Queue a message on a stream; it is fragmented and sent as the window allows
+    void send_message(std::uint16_t stream, const char *data, size_t len);
+
+    // Process one datagram received from the peer
+    void on_datagram(const char *data, size_t len, std::uint64_t now);
+
+    // Send what the window and pacing allow, run the retransmission timer, flush ACKs
+    void on_tick(std::uint64_t now);
+
+    // Earliest time on_tick() has work to do (timer, pacing or delayed ACK); 0 if none
+    std::uint64_t next_deadline() const;
+
+    // Take the next fully received message, if any
+    bool poll_message(RudpMessage &out);
+
+    // Packets queued or in flight; 0 once the peer has acknowledged everything
+    size_t unacked() const { return send_queue_.size() + inflight_.size(); }
+
+    std::uint64_t srtt_ns() const { return srtt_; }
+    const RudpStats &stats() const { return stats_; }
+    const sockaddr_in &peer() const { return peer_; }
+
+private:
+    struct Fragment {
+        std::uint16_t stream;
+        std::uint32_t msg_seq;
+        std::uint16_t frag_idx;
+        std::uint16_t frag_count;
+        std::string payload;
+        bool retransmission = false;
+    };
+
+    struct SentPacket {
+        Fragment frag;
+        std::uint64_t sent_at;
+    };
+
+    struct PartialMessage {
+        std::uint16_t received = 0;
+        std::vector<std::string> frags;
+        std::vector<bool> have;
+    };
+
+    struct StreamState {
+        std::uint32_t next_send_seq = 0;
+        std::uint32_t next_deliver_seq = 0;
+        std::map<std::uint32_t, PartialMessage> partial;
+    };
+
+    void send_datagram(const char *data, size_t len);
+    void transmit(Fragment frag, std::uint64_t now);
+    void send_ack();
+    void handle_data(const char *data, size_t len, std::uint64_t now);
+    void handle_ack(const char *data, size_t len, std::uint64_t now);
+    void advance_cum_ack();
+    void requeue_lost(const std::vector<std::uint32_t> &pkt_nums);
+    void update_rtt(std::uint64_t sample);
+
+    int sock_;
+    sockaddr_in peer_;
+    RudpOptions opts_;
+    std::mt19937 rng_;
+    RudpStats stats_;
+
+    // Sender
+    std::uint32_t next_pkt_num_ = 0;
+    std::deque<Fragment> send_queue_;              // Retransmissions go to the front
+    std::map<std::uint32_t, SentPacket> inflight_; // By packet number
+    std::uint32_t largest_acked_ = 0;
+    bool any_acked_ = false;
+    std::uint64_t srtt_ = 0, rttvar_ = 0;
+    std::uint64_t rto_;
+    std::uint64_t next_send_at_ = 0;               // Pacing
+
+    // Receiver
+    std::uint32_t cum_ack_ = 0;                    // Every packet below this has arrived
+    std::set<std::uint32_t> received_above_;       // Arrived packets above cum_ack_
+    bool ack_pending_ = false;
+    std::uint64_t ack_due_ = 0;
+    unsigned unacked_data_ = 0;
+    std::map<std::uint16_t, StreamState> streams_;
+    std::deque<RudpMessage> delivered_;
+};
+
+// Wait up to max_wait_ns for datagrams or the connection's next deadline, feed what
+// arrived on sock to conn and tick it
+void rudp_pump(RudpConnection &conn, int sock, std::uint64_t max_wait_ns);
+
+#endif // RUDP_H
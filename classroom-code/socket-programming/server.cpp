@@ -3,10 +3,58 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <string>
+#include "file_transfer.h"
 
 #define PORT 8080
 
-int main() {
+// File transfer mode: read the size header, store that many bytes, reply with the count
+int receive_file(int sock, const std::string &path, const std::string &mode) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("Could not open output file");
+        return -1;
+    }
+
+    std::uint64_t header = 0;
+    if (!read_exact(sock, &header, sizeof(header))) {
+        std::cerr << "No file size from client" << std::endl;
+        close(fd);
+        return -1;
+    }
+    std::uint64_t file_size = be64toh(header);
+
+    TransferClock start = TransferClock::now();
+    if (!recv_file_data(sock, fd, file_size, mode)) {
+        perror("File receive failed");
+        close(fd);
+        return -1;
+    }
+    TransferClock end = TransferClock::now();
+
+    std::uint64_t reply = htobe64(file_size);
+    write_all_fd(sock, reinterpret_cast<const char *>(&reply), sizeof(reply), true);
+    print_transfer_report("Received", mode, file_size, start, end);
+
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // Optional file transfer mode: --recv OUTFILE [--mode rw|splice|mmap]
+    std::string recv_path, mode = "splice";
+    bool args_ok = argc % 2 == 1;
+    for (int i = 1; args_ok && i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--recv") recv_path = argv[i + 1];
+        else if (arg == "--mode") mode = argv[i + 1];
+        else args_ok = false;
+    }
+    if (!args_ok || (mode != "rw" && mode != "splice" && mode != "mmap")) {
+        std::cerr << "Usage: " << argv[0] << " [--recv OUTFILE [--mode rw|splice|mmap]]" << std::endl;
+        return -1;
+    }
+
     int server_fd, new_socket;
     struct sockaddr_in address;
     int opt = 1;
@@ -50,6 +98,13 @@ int main() {
         exit(EXIT_FAILURE);
     }
 
+    if (!recv_path.empty()) {
+        int result = receive_file(new_socket, recv_path, mode);
+        close(new_socket);
+        close(server_fd);
+        return result;
+    }
+
     read(new_socket, buffer, 1024);
     std::cout << "Message from client: " << buffer << std::endl;
 
@@ -4,6 +4,20 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <map>
+#include <utility>
+#include <endian.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <atomic>
+#include <csignal>
+#include <chrono>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include "bench_common.h"
+#include "rudp.h"
 
 #define SERVER_PORT 8080
 #define BUFFER_SIZE 1024
@@ -47,7 +61,7 @@ void start_tcp_server() {
             perror("TCP receive failed");
         } else {
             std::cout << "TCP: Received " << bytes_received << " bytes: " << buffer << "\n";
-            std::cout << "TCP: Packet size (including headers) is " << (bytes_received + 20) << " bytes\n";
+            std::cout << "TCP: Packet size (including IPv4 + TCP headers) is " << (bytes_received + IPV4_HEADER + TCP_HEADER) << " bytes\n";
         }
         close(client_sock);
     }
@@ -87,14 +101,468 @@ void start_udp_server() {
         perror("UDP receive failed");
     } else {
         std::cout << "UDP: Received " << bytes_received << " bytes: " << buffer << "\n";
-        std::cout << "UDP: Packet size (including headers) is " << (bytes_received + 8) << " bytes\n";
+        std::cout << "UDP: Packet size (including IPv4 + UDP headers) is " << (bytes_received + IPV4_HEADER + UDP_HEADER) << " bytes\n";
     }
 
     close(udp_sock);
     std::cout << "UDP server closed.\n";
 }
 
-int main() {
+// ---------------------------------------------------------------------------
+// Benchmark mode: long-running TCP, UDP and reliable-UDP endpoints for
+// `compareclient --bench`
+// ---------------------------------------------------------------------------
+
+// Serve one benchmark TCP connection: echo (ping-pong) or sink-and-count (stream)
+void serve_bench_tcp_client(int client_sock) {
+    BenchHello hello;
+    if (!recv_all(client_sock, &hello, sizeof(hello))) {
+        close(client_sock);
+        return;
+    }
+    int nodelay = hello.nodelay;
+    setsockopt(client_sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    size_t msg_size = ntohl(hello.msg_size);
+
+    if (hello.kind == BENCH_PINGPONG) {
+        std::vector<char> buffer(msg_size);
+        while (recv_all(client_sock, buffer.data(), msg_size) &&
+               send_all(client_sock, buffer.data(), msg_size)) {
+        }
+    } else if (hello.kind == BENCH_STREAM) {
+        // Read until the client shuts down its side, then report the byte count
+        std::vector<char> buffer(256 * 1024);
+        std::uint64_t total = 0;
+        ssize_t n;
+        while ((n = recv(client_sock, buffer.data(), buffer.size(), 0)) > 0)
+            total += n;
+        std::uint64_t reply = htobe64(total);
+        send_all(client_sock, &reply, sizeof(reply));
+    }
+    close(client_sock);
+}
+
+void run_bench_tcp_server(int sndbuf, int rcvbuf) {
+    int tcp_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (tcp_sock < 0) {
+        perror("TCP socket creation failed");
+        return;
+    }
+    int opt = 1;
+    setsockopt(tcp_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    // Accepted sockets inherit the listening socket's buffer sizes
+    set_socket_buffers(tcp_sock, sndbuf, rcvbuf);
+
+    sockaddr_in server_addr = make_addr("", BENCH_PORT);
+    if (bind(tcp_sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("TCP bind failed");
+        close(tcp_sock);
+        return;
+    }
+    if (listen(tcp_sock, 128) < 0) {
+        perror("TCP listen failed");
+        close(tcp_sock);
+        return;
+    }
+    std::cout << "TCP bench server listening on port " << BENCH_PORT << "...\n";
+
+    // One thread per connection keeps concurrent flows independent
+    while (true) {
+        int client_sock = accept(tcp_sock, nullptr, nullptr);
+        if (client_sock < 0) {
+            perror("TCP accept failed");
+            continue;
+        }
+        std::thread(serve_bench_tcp_client, client_sock).detach();
+    }
+}
+
+void run_bench_udp_server(int sndbuf, int rcvbuf) {
+    int udp_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udp_sock < 0) {
+        perror("UDP socket creation failed");
+        return;
+    }
+    set_socket_buffers(udp_sock, sndbuf, rcvbuf);
+
+    sockaddr_in server_addr = make_addr("", BENCH_PORT);
+    if (bind(udp_sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("UDP bind failed");
+        close(udp_sock);
+        return;
+    }
+    std::cout << "UDP bench server listening on port " << BENCH_PORT << "...\n";
+
+    // Streamed bytes per client address:port since that client's last END
+    std::map<std::pair<std::uint32_t, std::uint16_t>, std::uint64_t> stream_bytes;
+    std::vector<char> buffer(UDP_MAX_PAYLOAD);
+
+    while (true) {
+        sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        ssize_t n = recvfrom(udp_sock, buffer.data(), buffer.size(), 0,
+                             (struct sockaddr *)&client_addr, &client_len);
+        if (n <= 0) continue;
+
+        auto key = std::make_pair(client_addr.sin_addr.s_addr, client_addr.sin_port);
+        switch (buffer[0]) {
+        case BENCH_PINGPONG:
+            sendto(udp_sock, buffer.data(), n, 0, (struct sockaddr *)&client_addr, client_len);
+            break;
+        case BENCH_STREAM:
+            stream_bytes[key] += n;
+            break;
+        case BENCH_END: {
+            std::uint64_t reply = htobe64(stream_bytes[key]);
+            sendto(udp_sock, &reply, sizeof(reply), 0, (struct sockaddr *)&client_addr, client_len);
+            stream_bytes.erase(key);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+// Reliable-UDP endpoint: one RudpConnection per client address:port, driven from a
+// single thread. Ping-pong messages are echoed on the stream they arrived on; stream
+// messages only need to be acknowledged, which the transport does by itself.
+void run_bench_rudp_server(int sndbuf, int rcvbuf, RudpOptions opts) {
+    int udp_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udp_sock < 0) {
+        perror("UDP socket creation failed");
+        return;
+    }
+    set_socket_buffers(udp_sock, sndbuf ? sndbuf : RUDP_SOCKET_BUFFER, rcvbuf ? rcvbuf : RUDP_SOCKET_BUFFER);
+
+    sockaddr_in server_addr = make_addr("", RUDP_BENCH_PORT);
+    if (bind(udp_sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("UDP bind failed");
+        close(udp_sock);
+        return;
+    }
+    std::cout << "Reliable-UDP bench server listening on port " << RUDP_BENCH_PORT << "...\n";
+
+    struct Peer {
+        std::unique_ptr<RudpConnection> conn;
+        std::uint64_t last_active;
+    };
+    std::map<std::pair<std::uint32_t, std::uint16_t>, Peer> peers;
+    constexpr std::uint64_t IDLE_NS = 30000000000ull;   // Forget clients silent this long
+    constexpr int RUDP_BATCH = 64;   // Tick this often so ACKs do not wait for a drained buffer
+    char buffer[RUDP_MAX_DATAGRAM];
+
+    while (true) {
+        // Sleep until a datagram arrives or the earliest connection timer is due
+        std::uint64_t now = now_ns();
+        std::uint64_t wait = 1000000000;
+        for (auto &p : peers) {
+            std::uint64_t deadline = p.second.conn->next_deadline();
+            if (deadline) wait = std::min(wait, deadline > now ? deadline - now : 0);
+        }
+        pollfd pfd{udp_sock, POLLIN, 0};
+        timespec ts{static_cast<time_t>(wait / 1000000000), static_cast<long>(wait % 1000000000)};
+        if (ppoll(&pfd, 1, &ts, nullptr) > 0) {
+            for (int i = 0; i < RUDP_BATCH; ++i) {
+                sockaddr_in client_addr;
+                socklen_t client_len = sizeof(client_addr);
+                ssize_t n = recvfrom(udp_sock, buffer, sizeof(buffer), MSG_DONTWAIT,
+                                     (struct sockaddr *)&client_addr, &client_len);
+                if (n < 0) break;
+                auto key = std::make_pair(client_addr.sin_addr.s_addr, client_addr.sin_port);
+                Peer &peer = peers[key];
+                if (!peer.conn)
+                    peer.conn = std::make_unique<RudpConnection>(udp_sock, client_addr, opts, ntohs(client_addr.sin_port));
+                peer.last_active = now_ns();
+                peer.conn->on_datagram(buffer, n, peer.last_active);
+            }
+        }
+
+        now = now_ns();
+        for (auto it = peers.begin(); it != peers.end();) {
+            RudpConnection &conn = *it->second.conn;
+            RudpMessage msg;
+            while (conn.poll_message(msg))
+                if (!msg.data.empty() && msg.data[0] == BENCH_PINGPONG)
+                    conn.send_message(msg.stream, msg.data.data(), msg.data.size());
+            conn.on_tick(now);
+            if (now - it->second.last_active > IDLE_NS) it = peers.erase(it);
+            else ++it;
+        }
+    }
+}
+
+int run_bench_server(int argc, char *argv[]) {
+    int sndbuf = 0, rcvbuf = 0;
+    RudpOptions rudp;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--sndbuf" && has_value) sndbuf = atoi(argv[++i]);
+        else if (arg == "--rcvbuf" && has_value) rcvbuf = atoi(argv[++i]);
+        else if (arg == "--loss" && has_value) rudp.loss_pct = atof(argv[++i]);
+        else if (arg == "--window" && has_value) rudp.max_inflight = std::max(1, atoi(argv[++i]));
+        else if (arg == "--pacing" && has_value) rudp.pacing_mbps = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: server_compare --bench [--sndbuf BYTES] [--rcvbuf BYTES]\n"
+                      << "                            [--loss PCT] [--window PKTS] [--pacing MBPS]\n"
+                      << "  --loss, --window and --pacing apply to the reliable-UDP endpoint\n";
+            return 1;
+        }
+    }
+
+    std::thread tcp_thread(run_bench_tcp_server, sndbuf, rcvbuf);
+    std::thread udp_thread(run_bench_udp_server, sndbuf, rcvbuf);
+    std::thread rudp_thread(run_bench_rudp_server, sndbuf, rcvbuf, rudp);
+    tcp_thread.join();
+    udp_thread.join();
+    rudp_thread.join();
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// UDP ingest mode: N worker threads, one SO_REUSEPORT socket each, batched
+// recvmmsg, optional UDP GRO, drop counting via SO_RXQ_OVFL, CPU pinning and
+// per-core packets/sec reporting.
+// ---------------------------------------------------------------------------
+
+struct IngestConfig {
+    int port = BENCH_PORT;
+    int workers = 1;
+    int batch = 64;              // Datagrams per recvmmsg call
+    bool gro = false;            // Let the kernel coalesce datagrams (UDP_GRO)
+    int rcvbuf = 0;              // SO_RCVBUF(FORCE), kernel default if 0
+    std::vector<long> cpus;      // CPU for each worker, worker index if empty
+    double interval = 1.0;       // Seconds between reports
+};
+
+// Per-worker counters, each on its own cache line
+struct alignas(64) IngestCounters {
+    std::atomic<std::uint64_t> packets{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> syscalls{0};
+    std::atomic<std::uint64_t> drops{0};   // Latest SO_RXQ_OVFL value (cumulative per socket)
+    int cpu = -1;
+};
+
+static std::atomic<bool> ingest_running{true};
+
+static void stop_ingest(int) {
+    ingest_running = false;
+}
+
+static int open_ingest_socket(const IngestConfig &cfg) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("UDP socket creation failed");
+        return -1;
+    }
+
+    int one = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+        perror("setsockopt(SO_REUSEPORT) failed");
+        close(sock);
+        return -1;
+    }
+    if (setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) < 0)
+        perror("setsockopt(SO_RXQ_OVFL) failed");
+    if (cfg.gro && setsockopt(sock, IPPROTO_UDP, UDP_GRO, &one, sizeof(one)) < 0)
+        perror("setsockopt(UDP_GRO) failed");
+    if (cfg.rcvbuf > 0) {
+        // SO_RCVBUFFORCE ignores rmem_max but needs CAP_NET_ADMIN
+        if (setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &cfg.rcvbuf, sizeof(cfg.rcvbuf)) < 0)
+            set_socket_buffers(sock, 0, cfg.rcvbuf);
+    }
+
+    // A 1 second timeout lets workers notice shutdown even when no traffic arrives
+    timeval tv{1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in server_addr = make_addr("", cfg.port);
+    if (bind(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        perror("UDP bind failed");
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static void ingest_worker(const IngestConfig &cfg, int sock, IngestCounters &counters) {
+    if (counters.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(counters.cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0)
+            std::cerr << "Could not pin worker to CPU " << counters.cpu << ": " << strerror(err) << "\n";
+    }
+
+    // With GRO one receive can carry many datagrams, so give each slot a full 64 KB
+    const size_t slot_size = cfg.gro ? 65536 : 2048;
+    const size_t control_size = CMSG_SPACE(sizeof(std::uint32_t)) + CMSG_SPACE(sizeof(int));
+    std::vector<char> data(slot_size * cfg.batch);
+    std::vector<char> control(control_size * cfg.batch);
+    std::vector<iovec> iov(cfg.batch);
+    std::vector<mmsghdr> msgs(cfg.batch);
+    std::vector<sockaddr_in> sources(cfg.batch);
+
+    // Streamed bytes per source, so `compareclient --bench` can get its delivery count back.
+    // SO_REUSEPORT hashes a flow to one socket, so each worker sees whole flows.
+    std::map<std::pair<std::uint32_t, std::uint16_t>, std::uint64_t> stream_bytes;
+
+    while (ingest_running.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < cfg.batch; ++i) {
+            iov[i] = {data.data() + i * slot_size, slot_size};
+            memset(&msgs[i].msg_hdr, 0, sizeof(msghdr));
+            msgs[i].msg_hdr.msg_name = &sources[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = control.data() + i * control_size;
+            msgs[i].msg_hdr.msg_controllen = control_size;
+        }
+
+        // Block for the first datagram, then take whatever else is already queued
+        int n = recvmmsg(sock, msgs.data(), cfg.batch, MSG_WAITFORONE, nullptr);
+        if (n <= 0) continue;
+        counters.syscalls.fetch_add(1, std::memory_order_relaxed);
+
+        std::uint64_t packets = 0, bytes = 0;
+        for (int i = 0; i < n; ++i) {
+            unsigned int len = msgs[i].msg_len;
+            int gso_size = 0;
+            for (cmsghdr *cm = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cm; cm = CMSG_NXTHDR(&msgs[i].msg_hdr, cm)) {
+                if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SO_RXQ_OVFL) {
+                    std::uint32_t dropped;
+                    memcpy(&dropped, CMSG_DATA(cm), sizeof(dropped));
+                    counters.drops.store(dropped, std::memory_order_relaxed);
+                } else if (cm->cmsg_level == IPPROTO_UDP && cm->cmsg_type == UDP_GRO) {
+                    memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+                }
+            }
+            // A coalesced GRO buffer holds len / gso_size datagrams (the last may be short)
+            packets += (gso_size > 0) ? (len + gso_size - 1) / gso_size : 1;
+            bytes += len;
+
+            const char *payload = static_cast<const char *>(iov[i].iov_base);
+            auto key = std::make_pair(sources[i].sin_addr.s_addr, sources[i].sin_port);
+            if (len > 0 && payload[0] == BENCH_STREAM) {
+                stream_bytes[key] += len;
+            } else if (len == 1 && payload[0] == BENCH_END) {
+                std::uint64_t reply = htobe64(stream_bytes[key]);
+                sendto(sock, &reply, sizeof(reply), 0, (struct sockaddr *)&sources[i], sizeof(sources[i]));
+                stream_bytes.erase(key);
+            }
+        }
+        counters.packets.fetch_add(packets, std::memory_order_relaxed);
+        counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    close(sock);
+}
+
+static void print_ingest_usage() {
+    std::cerr << "Usage: server_compare --udp-ingest [options]\n"
+              << "  --port P        UDP port (default " << BENCH_PORT << ")\n"
+              << "  --workers N     worker threads / SO_REUSEPORT sockets (default 1)\n"
+              << "  --batch N       datagrams per recvmmsg (default 64)\n"
+              << "  --gro           enable UDP_GRO\n"
+              << "  --rcvbuf BYTES  receive buffer per socket\n"
+              << "  --cpus LIST     CPU for each worker (default: worker index)\n"
+              << "  --interval SEC  report interval (default 1)\n";
+}
+
+int run_udp_ingest(int argc, char *argv[]) {
+    IngestConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--gro") cfg.gro = true;
+        else if (arg == "--port" && has_value) cfg.port = atoi(argv[++i]);
+        else if (arg == "--workers" && has_value) cfg.workers = atoi(argv[++i]);
+        else if (arg == "--batch" && has_value) cfg.batch = atoi(argv[++i]);
+        else if (arg == "--rcvbuf" && has_value) cfg.rcvbuf = atoi(argv[++i]);
+        else if (arg == "--cpus" && has_value) cfg.cpus = parse_list(argv[++i]);
+        else if (arg == "--interval" && has_value) cfg.interval = atof(argv[++i]);
+        else {
+            print_ingest_usage();
+            return 1;
+        }
+    }
+    if (cfg.workers < 1 || cfg.batch < 1) {
+        print_ingest_usage();
+        return 1;
+    }
+
+    signal(SIGINT, stop_ingest);
+    signal(SIGTERM, stop_ingest);
+
+    // Open every socket before starting workers so the reuseport group is complete
+    int ncpus = static_cast<int>(std::thread::hardware_concurrency());
+    std::vector<std::unique_ptr<IngestCounters>> counters;
+    std::vector<int> socks;
+    for (int w = 0; w < cfg.workers; ++w) {
+        int sock = open_ingest_socket(cfg);
+        if (sock < 0) return 1;
+        socks.push_back(sock);
+        counters.push_back(std::make_unique<IngestCounters>());
+        counters[w]->cpu = (w < static_cast<int>(cfg.cpus.size())) ? static_cast<int>(cfg.cpus[w])
+                                                                   : (ncpus > 0 ? w % ncpus : -1);
+    }
+
+    std::cout << "UDP ingest on port " << cfg.port << " with " << cfg.workers << " workers, batch "
+              << cfg.batch << (cfg.gro ? ", GRO" : "") << "\n";
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < cfg.workers; ++w)
+        workers.emplace_back(ingest_worker, std::cref(cfg), socks[w], std::ref(*counters[w]));
+
+    // Report per-core rates until interrupted
+    std::vector<std::uint64_t> last_packets(cfg.workers, 0), last_bytes(cfg.workers, 0);
+    auto last = std::chrono::steady_clock::now();
+    while (ingest_running) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(cfg.interval));
+        auto now = std::chrono::steady_clock::now();
+        double secs = std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        std::uint64_t total_pps = 0, total_drops = 0;
+        double total_mbps = 0;
+        for (int w = 0; w < cfg.workers; ++w) {
+            std::uint64_t packets = counters[w]->packets.load();
+            std::uint64_t bytes = counters[w]->bytes.load();
+            std::uint64_t pps = static_cast<std::uint64_t>((packets - last_packets[w]) / secs);
+            double mbps = (bytes - last_bytes[w]) * 8.0 / secs / 1e6;
+            last_packets[w] = packets;
+            last_bytes[w] = bytes;
+            total_pps += pps;
+            total_mbps += mbps;
+            total_drops += counters[w]->drops.load();
+            std::cout << "worker " << w << " cpu " << counters[w]->cpu << ": " << pps << " pkt/s, "
+                      << mbps << " Mbit/s, drops " << counters[w]->drops.load() << "\n";
+        }
+        std::cout << "total: " << total_pps << " pkt/s, " << total_mbps << " Mbit/s, drops "
+                  << total_drops << std::endl;
+    }
+
+    for (auto &t : workers) t.join();
+
+    std::uint64_t packets = 0, syscalls = 0;
+    for (auto &c : counters) {
+        packets += c->packets.load();
+        syscalls += c->syscalls.load();
+    }
+    std::cout << "UDP ingest stopped: " << packets << " packets in " << syscalls << " recvmmsg calls\n";
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return run_bench_server(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--udp-ingest") {
+        return run_udp_ingest(argc - 1, argv + 1);
+    }
+
     std::thread tcp_thread(start_tcp_server); // Thread for TCP server
     std::thread udp_thread(start_udp_server); // Thread for UDP server
 
@@ -0,0 +1,112 @@
+#ifndef SERVER_CORE_H
+#define SERVER_CORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+// Reusable single-threaded TCP server core with two interchangeable backends:
+//
+//  - epoll:    non-blocking sockets, accept4/recv/send driven by epoll_wait
+//  - io_uring: multishot accept, multishot recv into a provided-buffer ring,
+//              and per-connection chains of linked sends
+//
+// The application only supplies a DataHandler; both backends call it for every
+// chunk of bytes received and let it reply through Connection::send().
+
+class Connection {
+public:
+    virtual ~Connection() = default;
+
+    // Queue bytes to be sent; the data is copied, so the caller's buffer may be reused
+    virtual void send(const char *data, size_t len) = 0;
+
+    // Close the connection once all queued data has been sent
+    virtual void close() = 0;
+
+    virtual int fd() const = 0;
+};
+
+using DataHandler = std::function<void(Connection &conn, const char *data, size_t len)>;
+
+// Counters kept by the event loop; read them after run() has returned
+struct ServerStats {
+    std::uint64_t syscalls = 0;     // Every system call made by the event loop
+    std::uint64_t accepts = 0;
+    std::uint64_t recvs = 0;        // Completed receives that delivered data
+    std::uint64_t sends = 0;        // Completed send operations
+    std::uint64_t bytes_in = 0;
+    std::uint64_t bytes_out = 0;
+};
+
+class ServerCore {
+public:
+    virtual ~ServerCore() = default;
+
+    // Bind and listen on the port; returns false (after perror) on failure
+    virtual bool listen(int port) = 0;
+
+    // Run the event loop until stop() is called
+    virtual void run() = 0;
+
+    // Ask run() to return; safe to call from any thread
+    virtual void stop() = 0;
+
+    virtual const char *name() const = 0;
+
+    const ServerStats &stats() const { return stats_; }
+
+protected:
+    ServerStats stats_;
+};
+
+std::unique_ptr<ServerCore> make_epoll_server(DataHandler handler);
+std::unique_ptr<ServerCore> make_uring_server(DataHandler handler);
+
+// Create a listening TCP socket on INADDR_ANY:port; returns -1 (after perror) on failure
+inline int open_listen_socket(int port, int extra_flags = 0) {
+    int sock = socket(AF_INET, SOCK_STREAM | extra_flags, 0);
+    if (sock < 0) {
+        perror("Socket failed");
+        return -1;
+    }
+
+    int opt = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt))) {
+        perror("setsockopt");
+        close(sock);
+        return -1;
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+
+    if (bind(sock, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        perror("Bind failed");
+        close(sock);
+        return -1;
+    }
+    if (::listen(sock, SOMAXCONN) < 0) {
+        perror("Listen");
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// Replies go out as soon as they are produced; request/response traffic should not wait on Nagle
+inline void set_nodelay(int sock) {
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+#endif // SERVER_CORE_H
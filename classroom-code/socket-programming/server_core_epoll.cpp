@@ -0,0 +1,248 @@
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "server_core.h"
+
+// epoll backend: level-triggered readiness, non-blocking accept4/recv/send
+
+namespace {
+
+constexpr int MAX_EVENTS = 256;
+constexpr size_t RECV_BUFFER_SIZE = 64 * 1024;
+
+class EpollServer;
+
+class EpollConnection : public Connection {
+public:
+    EpollConnection(EpollServer &server, int fd) : server_(server), fd_(fd) {}
+
+    void send(const char *data, size_t len) override;
+    void close() override;
+    int fd() const override { return fd_; }
+
+    EpollServer &server_;
+    int fd_;
+    std::string pending_;       // Bytes the socket could not take yet
+    bool want_write_ = false;   // EPOLLOUT registered
+    bool closing_ = false;
+};
+
+class EpollServer : public ServerCore {
+public:
+    explicit EpollServer(DataHandler handler) : handler_(std::move(handler)) {}
+
+    ~EpollServer() override {
+        for (auto &entry : conns_) ::close(entry.first);
+        if (listen_fd_ >= 0) ::close(listen_fd_);
+        if (event_fd_ >= 0) ::close(event_fd_);
+        if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    }
+
+    bool listen(int port) override {
+        listen_fd_ = open_listen_socket(port, SOCK_NONBLOCK);
+        if (listen_fd_ < 0) return false;
+
+        epoll_fd_ = epoll_create1(0);
+        event_fd_ = eventfd(0, EFD_NONBLOCK);
+        if (epoll_fd_ < 0 || event_fd_ < 0) {
+            perror("epoll setup failed");
+            return false;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listen_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+        ev.data.fd = event_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev);
+        return true;
+    }
+
+    void run() override {
+        epoll_event events[MAX_EVENTS];
+        running_ = true;
+        while (running_) {
+            int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+            stats_.syscalls++;
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("epoll_wait failed");
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == event_fd_) {
+                    running_ = false;
+                } else if (fd == listen_fd_) {
+                    accept_all();
+                } else {
+                    auto it = conns_.find(fd);
+                    if (it == conns_.end()) continue;
+                    EpollConnection &conn = *it->second;
+                    if (events[i].events & EPOLLOUT) flush(conn);
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                        // A closing connection only drains its output; a send error ends it
+                        if (conn.closing_) flush(conn);
+                        else read_all(conn);
+                    }
+                }
+            }
+            reap();
+        }
+    }
+
+    void stop() override {
+        std::uint64_t one = 1;
+        if (write(event_fd_, &one, sizeof(one)) < 0)
+            perror("eventfd write failed");
+    }
+
+    const char *name() const override { return "epoll"; }
+
+    // Try to send right away; whatever the socket does not take waits for EPOLLOUT
+    void send(EpollConnection &conn, const char *data, size_t len) {
+        if (conn.pending_.empty()) {
+            while (len > 0) {
+                ssize_t n = ::send(conn.fd_, data, len, MSG_NOSIGNAL);
+                stats_.syscalls++;
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                    mark_closing(conn);
+                    return;
+                }
+                stats_.sends++;
+                stats_.bytes_out += n;
+                data += n;
+                len -= n;
+            }
+        }
+        if (len > 0) {
+            conn.pending_.append(data, len);
+            set_want_write(conn, true);
+        }
+    }
+
+    // Stop reading and close once pending_ has been flushed (see reap)
+    void mark_closing(EpollConnection &conn) {
+        if (!conn.closing_) {
+            conn.closing_ = true;
+            closing_.push_back(conn.fd_);
+            update_events(conn);
+        }
+    }
+
+private:
+    void accept_all() {
+        while (true) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK);
+            stats_.syscalls++;
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    perror("Accept");
+                return;
+            }
+            stats_.accepts++;
+            set_nodelay(fd);
+            stats_.syscalls++;
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+            stats_.syscalls++;
+            conns_[fd] = std::make_unique<EpollConnection>(*this, fd);
+        }
+    }
+
+    // Level-triggered: one recv per readiness event keeps connections fair
+    void read_all(EpollConnection &conn) {
+        ssize_t n = recv(conn.fd_, buffer_, sizeof(buffer_), 0);
+        stats_.syscalls++;
+        if (n > 0) {
+            stats_.recvs++;
+            stats_.bytes_in += n;
+            handler_(conn, buffer_, n);
+        } else if (n == 0) {
+            mark_closing(conn);           // Peer half-closed: queued replies still go out
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            conn.pending_.clear();
+            mark_closing(conn);
+        }
+    }
+
+    void flush(EpollConnection &conn) {
+        while (!conn.pending_.empty()) {
+            ssize_t n = ::send(conn.fd_, conn.pending_.data(), conn.pending_.size(), MSG_NOSIGNAL);
+            stats_.syscalls++;
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                conn.pending_.clear();
+                mark_closing(conn);
+                return;
+            }
+            stats_.sends++;
+            stats_.bytes_out += n;
+            conn.pending_.erase(0, n);
+        }
+        set_want_write(conn, false);
+    }
+
+    void set_want_write(EpollConnection &conn, bool want) {
+        if (conn.want_write_ == want) return;
+        conn.want_write_ = want;
+        update_events(conn);
+    }
+
+    // Level-triggered EOF would fire on every wait, so closing connections drop EPOLLIN
+    void update_events(EpollConnection &conn) {
+        epoll_event ev{};
+        if (!conn.closing_) ev.events |= EPOLLIN;
+        if (conn.want_write_) ev.events |= EPOLLOUT;
+        ev.data.fd = conn.fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd_, &ev);
+        stats_.syscalls++;
+    }
+
+    // Close connections marked during this round once their output has drained
+    void reap() {
+        std::vector<int> keep;
+        for (int fd : closing_) {
+            auto it = conns_.find(fd);
+            if (it == conns_.end()) continue;
+            if (!it->second->pending_.empty()) {
+                keep.push_back(fd);
+                continue;
+            }
+            ::close(fd);  // Also removes it from the epoll set
+            stats_.syscalls++;
+            conns_.erase(it);
+        }
+        closing_.swap(keep);
+    }
+
+    DataHandler handler_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int event_fd_ = -1;
+    bool running_ = false;
+    std::unordered_map<int, std::unique_ptr<EpollConnection>> conns_;
+    std::vector<int> closing_;
+    char buffer_[RECV_BUFFER_SIZE];
+};
+
+void EpollConnection::send(const char *data, size_t len) {
+    if (!closing_) server_.send(*this, data, len);
+}
+
+void EpollConnection::close() {
+    server_.mark_closing(*this);
+}
+
+} // namespace
+
+std::unique_ptr<ServerCore> make_epoll_server(DataHandler handler) {
+    return std::make_unique<EpollServer>(std::move(handler));
+}
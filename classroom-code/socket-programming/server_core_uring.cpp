@@ -0,0 +1,491 @@
+#include <algorithm>
+#include <cerrno>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "server_core.h"
+
+// io_uring backend, talking to the kernel through the raw system calls (no liburing):
+//
+//  - one multishot accept on the listening socket
+//  - one multishot recv per connection, taking buffers from a provided-buffer ring
+//  - sends produced while handling one batch of completions are submitted as a linked
+//    chain per connection, so they run in order; output produced while a chain is still
+//    in flight waits in a backlog and becomes the next chain
+
+namespace {
+
+constexpr unsigned RING_ENTRIES = 1024;
+constexpr unsigned BUF_COUNT = 512;          // Provided buffers, must be a power of two
+constexpr unsigned BUF_SIZE = 16 * 1024;
+constexpr std::uint16_t BUF_GROUP = 0;
+
+int sys_io_uring_setup(unsigned entries, io_uring_params *p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// Minimal submission/completion ring
+class Ring {
+public:
+    ~Ring() { close(); }
+
+    // Unmap the rings and close the ring fd, cancelling whatever is still pending
+    void close() {
+        if (sq_ptr_ && sq_ptr_ != MAP_FAILED) munmap(sq_ptr_, sq_size_);
+        if (cq_ptr_ && cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_size_);
+        if (sqes_ && sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        if (fd_ >= 0) ::close(fd_);
+        sq_ptr_ = cq_ptr_ = nullptr;
+        sqes_ = nullptr;
+        fd_ = -1;
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        p.flags = IORING_SETUP_CQSIZE;
+        p.cq_entries = entries * 4;   // Multishot requests produce many completions each
+        fd_ = sys_io_uring_setup(entries, &p);
+        if (fd_ < 0) {
+            perror("io_uring_setup failed");
+            return false;
+        }
+
+        sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+        sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        cq_ptr_ = (p.features & IORING_FEAT_SINGLE_MMAP)
+                      ? sq_ptr_
+                      : mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(
+            mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+        if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            perror("io_uring mmap failed");
+            return false;
+        }
+
+        char *sq = static_cast<char *>(sq_ptr_);
+        char *cq = static_cast<char *>(cq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        sq_entries_ = p.sq_entries;
+        cq_head_ = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+        local_tail_ = *sq_tail_;
+        return true;
+    }
+
+    int fd() const { return fd_; }
+
+    // True if get_sqe() can hand out an entry without submitting first
+    bool has_space() const {
+        return local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) < sq_entries_;
+    }
+
+    // Next free submission entry, zeroed; submits queued entries first if the ring is full
+    io_uring_sqe *get_sqe() {
+        if (!has_space()) submit(0);
+        unsigned idx = local_tail_ & sq_mask_;
+        io_uring_sqe *sqe = &sqes_[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+        local_tail_++;
+        return sqe;
+    }
+
+    // Publish queued entries and enter the kernel, waiting for wait_nr completions
+    int submit(unsigned wait_nr) {
+        unsigned to_submit = local_tail_ - *sq_tail_;
+        __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+        submit_gen_++;
+        enter_calls_++;
+        int ret = sys_io_uring_enter(fd_, to_submit, wait_nr, wait_nr ? IORING_ENTER_GETEVENTS : 0);
+        if (ret < 0 && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+            perror("io_uring_enter failed");
+        return ret;
+    }
+
+    // Visit every available completion, then release them to the kernel
+    template <typename F>
+    void for_each_cqe(F &&visit) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+            visit(cqes_[head & cq_mask_]);
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+    // Increases on every submit(); tells whether an entry is still unsubmitted
+    std::uint64_t submit_gen() const { return submit_gen_; }
+    std::uint64_t enter_calls() const { return enter_calls_; }
+
+private:
+    int fd_ = -1;
+    void *sq_ptr_ = nullptr;
+    void *cq_ptr_ = nullptr;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sq_size_ = 0, cq_size_ = 0, sqes_size_ = 0;
+    unsigned *sq_head_ = nullptr, *sq_tail_ = nullptr, *sq_array_ = nullptr;
+    unsigned sq_mask_ = 0, sq_entries_ = 0;
+    unsigned *cq_head_ = nullptr, *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+    unsigned local_tail_ = 0;
+    std::uint64_t submit_gen_ = 0;
+    std::uint64_t enter_calls_ = 0;
+};
+
+class UringServer;
+class UringConnection;
+
+enum OpType : std::uint8_t { OP_ACCEPT, OP_RECV, OP_SEND, OP_WAKE };
+
+// Every submission's user_data points at one of these
+struct Op {
+    OpType type;
+    UringConnection *conn = nullptr;
+    std::vector<char> data;   // Send payload, owned until the send completes
+};
+
+class UringConnection : public Connection {
+public:
+    UringConnection(UringServer &server, int fd) : server_(server), fd_(fd) {
+        recv_op_.type = OP_RECV;
+        recv_op_.conn = this;
+    }
+
+    ~UringConnection() override {
+        for (Op *op : sends_) delete op;
+    }
+
+    void send(const char *data, size_t len) override;
+    void close() override;
+    int fd() const override { return fd_; }
+
+    UringServer &server_;
+    int fd_;
+    Op recv_op_;
+    bool recv_armed_ = false;
+    bool closing_ = false;
+    bool shut_down_ = false;
+    unsigned inflight_ = 0;                     // Sends queued or running in the kernel
+    io_uring_sqe *last_send_ = nullptr;         // Tail of the chain being built
+    std::uint64_t last_send_gen_ = 0;           // Ring submit generation when it was queued
+    std::vector<std::vector<char>> backlog_;    // Output waiting for the running chain
+    std::unordered_set<Op *> sends_;            // Send ops in the kernel, owned until they complete
+};
+
+class UringServer : public ServerCore {
+public:
+    explicit UringServer(DataHandler handler) : handler_(std::move(handler)) {
+        accept_op_.type = OP_ACCEPT;
+        wake_op_.type = OP_WAKE;
+    }
+
+    ~UringServer() override {
+        // Pending multishot requests keep their sockets alive past close(), so shut them
+        // down first; otherwise the port stays bound until the ring is torn down
+        for (auto &entry : conns_) {
+            shutdown(entry.first, SHUT_RDWR);
+            ::close(entry.first);
+        }
+        if (listen_fd_ >= 0) {
+            shutdown(listen_fd_, SHUT_RDWR);
+            ::close(listen_fd_);
+        }
+        if (event_fd_ >= 0) ::close(event_fd_);
+
+        // Cancel what is left in the ring before freeing the send ops it points at
+        ring_.close();
+        conns_.clear();
+        if (buf_ring_) munmap(buf_ring_, BUF_COUNT * sizeof(io_uring_buf));
+    }
+
+    bool listen(int port) override {
+        listen_fd_ = open_listen_socket(port);
+        event_fd_ = eventfd(0, 0);
+        if (listen_fd_ < 0 || event_fd_ < 0) return false;
+        if (!ring_.init(RING_ENTRIES)) return false;
+        return setup_buffers();
+    }
+
+    void run() override {
+        arm_accept();
+        arm_wake();
+        running_ = true;
+        while (running_) {
+            ring_.submit(1);
+            ring_.for_each_cqe([this](const io_uring_cqe &cqe) { complete(cqe); });
+            __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+        }
+        stats_.syscalls += ring_.enter_calls();
+    }
+
+    void stop() override {
+        std::uint64_t one = 1;
+        if (write(event_fd_, &one, sizeof(one)) < 0)
+            perror("eventfd write failed");
+    }
+
+    const char *name() const override { return "io_uring"; }
+
+    void send(UringConnection &conn, const char *data, size_t len) {
+        if (conn.closing_) return;
+
+        // A chain already handed to the kernel cannot be extended; wait for it to finish
+        bool chain_submitted = conn.inflight_ > 0 && conn.last_send_gen_ != ring_.submit_gen();
+        if (chain_submitted || !conn.backlog_.empty()) {
+            conn.backlog_.emplace_back(data, data + len);
+            return;
+        }
+
+        // Make room first so the previous send is guaranteed to still be unsubmitted
+        if (!ring_.has_space()) {
+            ring_.submit(0);
+            if (conn.inflight_ > 0) {
+                conn.backlog_.emplace_back(data, data + len);
+                return;
+            }
+        }
+        queue_send(conn, std::vector<char>(data, data + len));
+    }
+
+    void close(UringConnection &conn) {
+        conn.closing_ = true;
+        try_finish(conn);
+    }
+
+private:
+    bool setup_buffers() {
+        buf_ring_ = static_cast<io_uring_buf_ring *>(mmap(nullptr, BUF_COUNT * sizeof(io_uring_buf),
+                                                           PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buf_ring_ == MAP_FAILED) {
+            buf_ring_ = nullptr;
+            perror("Buffer ring allocation failed");
+            return false;
+        }
+
+        io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<std::uint64_t>(buf_ring_);
+        reg.ring_entries = BUF_COUNT;
+        reg.bgid = BUF_GROUP;
+        if (sys_io_uring_register(ring_.fd(), IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            perror("IORING_REGISTER_PBUF_RING failed");
+            return false;
+        }
+
+        buffers_.resize(static_cast<size_t>(BUF_COUNT) * BUF_SIZE);
+        for (unsigned bid = 0; bid < BUF_COUNT; ++bid)
+            recycle(static_cast<std::uint16_t>(bid));
+        __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Hand a buffer back to the kernel; published at the end of each completion batch
+    void recycle(std::uint16_t bid) {
+        // Index the entries directly: in C++ the header's flexible-array wrapper
+        // shifts `bufs` away from offset 0, where the kernel expects entry 0
+        io_uring_buf *entries = reinterpret_cast<io_uring_buf *>(buf_ring_);
+        io_uring_buf *buf = &entries[buf_tail_ & (BUF_COUNT - 1)];
+        buf->addr = reinterpret_cast<std::uint64_t>(buffers_.data() + static_cast<size_t>(bid) * BUF_SIZE);
+        buf->len = BUF_SIZE;
+        buf->bid = bid;
+        buf_tail_++;
+    }
+
+    void arm_accept() {
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd_;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->user_data = reinterpret_cast<std::uint64_t>(&accept_op_);
+    }
+
+    void arm_wake() {
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = event_fd_;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&wake_value_);
+        sqe->len = sizeof(wake_value_);
+        sqe->user_data = reinterpret_cast<std::uint64_t>(&wake_op_);
+    }
+
+    void arm_recv(UringConnection &conn) {
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = conn.fd_;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUF_GROUP;
+        sqe->user_data = reinterpret_cast<std::uint64_t>(&conn.recv_op_);
+        conn.recv_armed_ = true;
+    }
+
+    // Append a send to the connection's chain, linking it to the previous unsubmitted send
+    void queue_send(UringConnection &conn, std::vector<char> payload) {
+        if (conn.inflight_ > 0 && conn.last_send_ && conn.last_send_gen_ == ring_.submit_gen())
+            conn.last_send_->flags |= IOSQE_IO_LINK;
+
+        Op *op = new Op{OP_SEND, &conn, std::move(payload)};
+        conn.sends_.insert(op);
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = conn.fd_;
+        sqe->addr = reinterpret_cast<std::uint64_t>(op->data.data());
+        sqe->len = static_cast<std::uint32_t>(op->data.size());
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;   // Retry short sends inside the kernel
+        sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+
+        conn.last_send_ = sqe;
+        conn.last_send_gen_ = ring_.submit_gen();
+        conn.inflight_++;
+    }
+
+    void complete(const io_uring_cqe &cqe) {
+        Op *op = reinterpret_cast<Op *>(cqe.user_data);
+        switch (op->type) {
+        case OP_WAKE:
+            running_ = false;
+            break;
+        case OP_ACCEPT:
+            if (cqe.res >= 0) {
+                stats_.accepts++;
+                set_nodelay(cqe.res);
+                stats_.syscalls++;
+                auto conn = std::make_unique<UringConnection>(*this, cqe.res);
+                arm_recv(*conn);
+                conns_[cqe.res] = std::move(conn);
+            }
+            if (!(cqe.flags & IORING_CQE_F_MORE)) arm_accept();
+            break;
+        case OP_RECV:
+            complete_recv(*op->conn, cqe);
+            break;
+        case OP_SEND:
+            complete_send(op, cqe);
+            break;
+        }
+    }
+
+    void complete_recv(UringConnection &conn, const io_uring_cqe &cqe) {
+        bool more = cqe.flags & IORING_CQE_F_MORE;
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            std::uint16_t bid = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (cqe.res > 0) {
+                stats_.recvs++;
+                stats_.bytes_in += cqe.res;
+                handler_(conn, buffers_.data() + static_cast<size_t>(bid) * BUF_SIZE, cqe.res);
+            }
+            recycle(bid);
+        }
+        if (more) return;
+
+        conn.recv_armed_ = false;
+        if (cqe.res == 0 || (cqe.res < 0 && cqe.res != -ENOBUFS)) {
+            conn.closing_ = true;         // Peer closed or the connection failed
+        } else if (!conn.closing_) {
+            arm_recv(conn);               // Out of buffers, or the kernel ended the multishot
+            return;
+        }
+        try_finish(conn);
+    }
+
+    void complete_send(Op *op, const io_uring_cqe &cqe) {
+        UringConnection &conn = *op->conn;
+        conn.sends_.erase(op);
+        delete op;
+        conn.inflight_--;
+        if (cqe.res >= 0) {
+            stats_.sends++;
+            stats_.bytes_out += cqe.res;
+        } else {
+            conn.closing_ = true;         // Includes -ECANCELED for the rest of a broken chain
+            conn.backlog_.clear();
+        }
+
+        if (conn.inflight_ == 0) {
+            conn.last_send_ = nullptr;
+            // A closing connection still drains its backlog; only a send error drops it
+            if (!conn.backlog_.empty()) {
+                std::vector<std::vector<char>> next;
+                next.swap(conn.backlog_);
+                for (auto &payload : next) {
+                    if (!ring_.has_space() && conn.inflight_ > 0) {
+                        // The chain so far got submitted; the rest waits for it
+                        conn.backlog_.push_back(std::move(payload));
+                        continue;
+                    }
+                    queue_send(conn, std::move(payload));
+                }
+                return;
+            }
+        }
+        try_finish(conn);
+    }
+
+    // Close a connection once nothing of it is left in the kernel
+    void try_finish(UringConnection &conn) {
+        if (!conn.closing_ || conn.inflight_ > 0 || !conn.backlog_.empty()) return;
+        if (conn.recv_armed_) {
+            // The multishot recv holds its own file reference, so close() alone would not
+            // end it; shutting the socket down completes it with a final 0
+            if (!conn.shut_down_) {
+                shutdown(conn.fd_, SHUT_RDWR);
+                stats_.syscalls++;
+                conn.shut_down_ = true;
+            }
+            return;
+        }
+        ::close(conn.fd_);
+        stats_.syscalls++;
+        conns_.erase(conn.fd_);
+    }
+
+    DataHandler handler_;
+    Ring ring_;
+    int listen_fd_ = -1;
+    int event_fd_ = -1;
+    bool running_ = false;
+    std::uint64_t wake_value_ = 0;
+    Op accept_op_;
+    Op wake_op_;
+    io_uring_buf_ring *buf_ring_ = nullptr;
+    std::uint16_t buf_tail_ = 0;
+    std::vector<char> buffers_;
+    std::unordered_map<int, std::unique_ptr<UringConnection>> conns_;
+};
+
+void UringConnection::send(const char *data, size_t len) {
+    server_.send(*this, data, len);
+}
+
+void UringConnection::close() {
+    server_.close(*this);
+}
+
+} // namespace
+
+std::unique_ptr<ServerCore> make_uring_server(DataHandler handler) {
+    return std::make_unique<UringServer>(std::move(handler));
+}